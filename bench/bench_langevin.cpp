@@ -0,0 +1,142 @@
+/**
+ * @file bench_langevin.cpp
+ * @brief Throughput harness for the DPLangevin integrator.
+ *
+ * Times the deterministic right-hand-side sweep on its own (both by per-cell
+ * virtual calls and block-wise, as the integrators do), and complete
+ * Runge-Kutta (stage by stage, and cache-blocked) and Euler integration
+ * steps, on 1D and 2D grids, with density grids in double and in single
+ * precision, and reports cell updates per second. 
+ * 
+ * For Runge-Kutta, it also reports the main-memory traffic per cell per step
+ * implied by the number of whole-grid sweeps each method makes: the
+ * stage-by-stage method streams 18 grids of doubles through memory
+ * each step, while the cache-blocked method streams only the density grid,
+ * in and out, as long as its wavefront of blocks (reported here) fits in
+ * cache. The speedup is only seen for grids that are too big for cache.
+ *
+ * Built only when the `benchmarks` Meson option is enabled:
+ * 
+ *     meson setup build -Dbenchmarks=true; meson compile -C build
+ *     ./build/bench_langevin [n_x n_y n_steps]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "dplangevin.hpp"
+
+//! Wall-clock seconds taken to call `step` `n_steps` times
+template<typename F>
+double time_steps(const int n_steps, F step)
+{
+    const auto t_start = std::chrono::steady_clock::now();
+    for (auto i=0; i<n_steps; i++) { step(); }
+    const auto t_end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t_end - t_start).count();
+}
+
+//! Run all benchmarks on one grid and print cell updates per second
+template<typename real_t>
+void bench_grid(
+    const GridDimension grid_dimension, 
+    const int_vec_t grid_size, 
+    const gt_vec_t grid_topologies,
+    const int n_steps
+)
+{
+    const bc_vec_t bcs(
+        2*grid_size.size(), BoundaryCondition::FLOATING
+    );
+    Parameters p(
+        n_steps*0.01, 0.5, 0.01, 1, 
+        grid_dimension, grid_size, grid_topologies,
+        bcs, dbl_vec_t(bcs.size(), 0.0),
+        InitialCondition::RANDOM_UNIFORM, {0, 1},
+        IntegrationMethod::RUNGE_KUTTA,
+        RandomGenerator::MERSENNE_TWISTER,
+        (sizeof(real_t)==sizeof(float)) ? Precision::FLOAT32 : Precision::FLOAT64
+    );
+    typedef typename DPLangevin<real_t>::grid_t grid_t;
+    rng_t rng(p.random_seed);
+    DPLangevin<real_t> dpLangevin(p);
+    dpLangevin.construct_grid(p);
+    dpLangevin.plan_boundary_conditions(p);
+    dpLangevin.initialize_grid(p, rng);
+    dpLangevin.prepare(Coefficients(1.0, 2.0, 0.1, 1.0));
+
+    // Deterministic stencil only, as evaluated in each Runge-Kutta stage
+    grid_t density(p.n_cells, 0.0);
+    for (auto i=0; i<p.n_cells; i++) 
+    { 
+        density[i] = dpLangevin.get_density_grid_value(i); 
+    }
+    grid_t rhs(p.n_cells, 0.0);
+    const Langevin<real_t>& baseLangevin = dpLangevin;
+    const auto t_rhs_cell = time_steps(n_steps, [&]()
+    {
+        for (auto i=0; i<p.n_cells; i++)
+        {
+            rhs[i] = baseLangevin.nonlinear_rhs(i, density);
+        }
+    });
+    const auto t_rhs_block = time_steps(n_steps, [&]()
+    {
+        baseLangevin.nonlinear_rhs_block(density, 0, p.n_cells, rhs);
+    });
+    const auto t_rk = time_steps(
+        n_steps, [&](){ dpLangevin.integrate_rungekutta(rng); }
+    );
+    const auto t_rk_blocked = time_steps(
+        n_steps, [&](){ dpLangevin.integrate_rungekutta_blocked(rng); }
+    );
+    const auto t_euler = time_steps(
+        n_steps, [&](){ dpLangevin.integrate_euler(rng); }
+    );
+
+    // Whole-grid sweeps per Runge-Kutta step: reads + writes of density, 
+    // aux & k grids by the four stages (3, 4, 4, 7) versus density in & out
+    const auto n_sweeps_rk = 18;
+    const auto n_sweeps_rk_blocked = 2;
+    // Cells in flight in the wavefront: about five blocks of five grids
+    const auto n_wavefront_bytes = (
+        5*5*std::min(p.n_cells, 4096)*sizeof(real_t)
+    );
+
+    const auto n_updates = static_cast<double>(p.n_cells)*n_steps;
+    std::printf(
+        "%s %s %8d cells  %-36s  rhs/cell: %8.2f  rhs/block: %8.2f"
+        "  rk4: %6.2f  rk4/blocked: %6.2f  euler: %6.2f  Mcells/s"
+        "  (rk4 traffic: %3d vs %2d B/cell, wavefront %4zu kB)\n",
+        p.report(grid_dimension).c_str(), 
+        (sizeof(real_t)==sizeof(float)) ? "float32" : "float64",
+        p.n_cells,
+        p.report(grid_dimension, grid_topologies).c_str(),
+        n_updates/t_rhs_cell/1e6, n_updates/t_rhs_block/1e6, 
+        n_updates/t_rk/1e6, n_updates/t_rk_blocked/1e6,
+        n_updates/t_euler/1e6,
+        n_sweeps_rk*static_cast<int>(sizeof(real_t)), 
+        n_sweeps_rk_blocked*static_cast<int>(sizeof(real_t)),
+        n_wavefront_bytes/1024
+    );
+}
+
+int main(int argc, char** argv)
+{
+    const int n_x = (argc>1) ? std::atoi(argv[1]) : 1000;
+    const int n_y = (argc>2) ? std::atoi(argv[2]) : 1000;
+    const int n_steps = (argc>3) ? std::atoi(argv[3]) : 10;
+    const auto B = GridTopology::BOUNDED;
+    const auto P = GridTopology::PERIODIC;
+
+    bench_grid<double>(GridDimension::D1, {n_x*n_y}, {P}, n_steps);
+    bench_grid<double>(GridDimension::D1, {n_x*n_y}, {B}, n_steps);
+    bench_grid<double>(GridDimension::D2, {n_x, n_y}, {P, P}, n_steps);
+    bench_grid<double>(GridDimension::D2, {n_x, n_y}, {B, P}, n_steps);
+    bench_grid<double>(GridDimension::D2, {n_x, n_y}, {B, B}, n_steps);
+    bench_grid<float>(GridDimension::D1, {n_x*n_y}, {P}, n_steps);
+    bench_grid<float>(GridDimension::D2, {n_x, n_y}, {P, P}, n_steps);
+    bench_grid<float>(GridDimension::D2, {n_x, n_y}, {B, B}, n_steps);
+    return 0;
+}
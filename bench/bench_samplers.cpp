@@ -0,0 +1,68 @@
+/**
+ * @file bench_samplers.cpp
+ * @brief Microbenchmark of the Dornic-step samplers vs the `std::` ones.
+ *
+ * For several Poisson means, draws the Poisson-then-gamma pair of the 
+ * Dornic stochastic step many times over, both with `std::` distributions
+ * constructed afresh for each draw (as the integrator used to do) and with 
+ * the samplers in langevin_samplers.hpp, and reports draws per second along
+ * with the sample mean and variance of the gamma variates as a sanity check.
+ * Built only when the `benchmarks` Meson option is enabled:
+ *
+ *     ./build/bench_samplers [n_draws]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "langevin_types.hpp"
+#include "langevin_samplers.hpp"
+
+//! Draw n Poisson-gamma pairs with `sampler`; print rate, mean and variance
+template<typename F>
+void bench_sampler(const char* name, const int n_draws, F sampler)
+{
+    double sum = 0.0, sum_squares = 0.0;
+    const auto t_start = std::chrono::steady_clock::now();
+    for (auto i=0; i<n_draws; i++)
+    {
+        const auto x = sampler();
+        sum += x;
+        sum_squares += x*x;
+    }
+    const auto t_end = std::chrono::steady_clock::now();
+    const auto t = std::chrono::duration<double>(t_end - t_start).count();
+    const auto mean = sum/n_draws;
+    std::printf(
+        "  %-6s %8.2f Mdraws/s   mean: %10.5f   variance: %10.5f\n",
+        name, n_draws/t/1e6, mean, sum_squares/n_draws - mean*mean
+    );
+}
+
+int main(int argc, char** argv)
+{
+    const int n_draws = (argc>1) ? std::atoi(argv[1]) : 2000000;
+    // Gamma scale 1/λ: sample mean should be ≈ poisson_mean*scale and
+    // variance ≈ 2*poisson_mean*scale²
+    const double scale = 0.5;
+    for (const double poisson_mean : {0.0, 0.3, 3.0, 30.0, 300.0})
+    {
+        std::printf(
+            "Poisson mean %g: expect mean %g, variance %g\n", 
+            poisson_mean, poisson_mean*scale, 2*poisson_mean*scale*scale
+        );
+        rng_t rng(1);
+        bench_sampler("std::", n_draws, [&]()
+        {
+            poisson_dist_t poisson_sampler(poisson_mean);
+            gamma_dist_t gamma_sampler(poisson_sampler(rng), scale);
+            return gamma_sampler(rng);
+        });
+        bench_sampler("dornic", n_draws, [&]()
+        {
+            const auto n_poisson = sample_poisson(poisson_mean, rng);
+            return sample_gamma(n_poisson, scale, rng);
+        });
+    }
+    return 0;
+}
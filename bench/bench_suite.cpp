@@ -0,0 +1,327 @@
+/**
+ * @file bench_suite.cpp
+ * @brief Throughput benchmark suite for the DPLangevin integrators,
+ * with results written as JSON for tracking regressions between releases.
+ *
+ * Times Euler, Runge-Kutta and cache-blocked Runge-Kutta integration steps
+ * over a fixed matrix of cases:
+ *   - 1D and 2D grids of 2^10, 2^14, 2^18 and 2^22 cells, whose density
+ *     grids (and scratch grids) range from L1-resident to DRAM-resident;
+ *   - every combination of bounded and periodic edge topologies;
+ *   - two regimes: "active", deep in the active phase and started from
+ *     a dense random field, and "near_critical", with the linear
+ *     coefficient close to its critical value (for the other coefficients
+ *     used here) and started from a sparse, low-density random field,
+ *     so that many cells and some blocks are empty and skipped.
+ *
+ * Each case is timed step by step, until at least `min_seconds` have been
+ * spent over at least `n_min_steps` steps, in rounds of up to 
+ * `n_round_steps` steps that each start afresh from the initial condition
+ * (so that small grids can't reach the absorbing state however long 
+ * they're timed, while DRAM-resident grids take only a few steps). 
+ * The median step time gives the headline rate of cell updates per second,
+ * which is robust to the odd interrupted step; the mean and fastest step
+ * times are recorded alongside it.
+ *
+ * Built only when the `benchmarks` Meson option is enabled:
+ *
+ *     meson setup build -Dbenchmarks=true; meson compile -C build
+ *     ./build/bench_suite [results.json [n_threads [min_seconds]]]
+ *
+ * Results go to stdout if no file (or "-") is given. With more than one
+ * thread, the Philox per-cell rng is used, since the Mersenne Twister
+ * stochastic step is serial. Each result records the number of threads
+ * its method actually ran on: the blocked Runge-Kutta wavefront only
+ * ever runs on the calling thread.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "dplangevin.hpp"
+#include "langevin_threads.hpp"
+
+//! Integration steps in each timing round
+const int n_round_steps = 100;
+//! Fewest integration steps timed in each case
+const int n_min_steps = 5;
+//! Coefficients shared by all cases, besides the linear one
+const double quadratic = 2.0, diffusion = 0.1, noise = 1.0;
+//! Grid spacing and time step shared by all cases
+const double dx = 0.5, dt = 0.01;
+
+//! An integration regime: the linear coefficient for 1D and 2D grids,
+//! and the bounds of the uniformly random initial density field
+struct Regime
+{
+    const char* name;
+    double linear_1d, linear_2d;
+    double ic_max;
+};
+
+//! An integration method, the number of grids of cells it touches
+//! each step (density plus scratch grids), and whether it shares its 
+//! sweeps across the thread pool (or runs only on the calling thread)
+struct Method
+{
+    const char* name;
+    IntegrationMethod integration_method;
+    void (BaseLangevin::*integrate)(rng_t&);
+    int n_grids;
+    bool is_threaded;
+};
+
+//! Median of a list of times (which is reordered)
+static double median(dbl_vec_t& times)
+{
+    const auto middle = times.begin() + times.size()/2;
+    std::nth_element(times.begin(), middle, times.end());
+    return *middle;
+}
+
+//! Nominal level of the memory hierarchy that a working set resides in
+static const char* residency(const size_t n_bytes)
+{
+    if (n_bytes<=32*1024) { return "L1"; }
+    if (n_bytes<=1024*1024) { return "L2"; }
+    if (n_bytes<=16*1024*1024) { return "L3"; }
+    return "DRAM";
+}
+
+//! Time one method on one grid in one regime, and append its JSON record
+//! to `json`
+template<typename real_t>
+void bench_case(
+    const GridDimension grid_dimension,
+    const int_vec_t& grid_size,
+    const gt_vec_t& grid_topologies,
+    const Regime& regime,
+    const Method& method,
+    const RandomGenerator random_generator,
+    ThreadPool& thread_pool,
+    const double min_seconds,
+    std::ostringstream& json
+)
+{
+    const bc_vec_t bcs(2*grid_size.size(), BoundaryCondition::FLOATING);
+    Parameters p(
+        n_round_steps*dt, dx, dt, 1,
+        grid_dimension, grid_size, grid_topologies,
+        bcs, dbl_vec_t(bcs.size(), 0.0),
+        InitialCondition::RANDOM_UNIFORM, {0, regime.ic_max},
+        method.integration_method,
+        random_generator,
+        (sizeof(real_t)==sizeof(float)) ? Precision::FLOAT32 : Precision::FLOAT64
+    );
+    const auto linear = (grid_dimension==GridDimension::D1)
+        ? regime.linear_1d : regime.linear_2d;
+    rng_t rng(p.random_seed);
+    DPLangevin<real_t> dpLangevin(p);
+    dpLangevin.set_thread_pool(&thread_pool);
+    dpLangevin.construct_grid(p);
+    dpLangevin.plan_boundary_conditions(p);
+    dpLangevin.prepare(Coefficients(linear, quadratic, diffusion, noise));
+
+    // Time rounds of steps, each from a fresh initial condition
+    dbl_vec_t step_times;
+    double total_seconds = 0.0;
+    double active_fraction_sum = 0.0;
+    int n_rounds = 0;
+    auto is_done = [&]()
+    {
+        return (
+            total_seconds>=min_seconds 
+            and static_cast<int>(step_times.size())>=n_min_steps
+        );
+    };
+    while (not is_done())
+    {
+        dpLangevin.initialize_grid(p, rng);
+        // Untimed first step, to warm caches and settle block activity
+        (dpLangevin.*method.integrate)(rng);
+        for (auto i=1; i<n_round_steps and not is_done(); i++)
+        {
+            const auto t_start = std::chrono::steady_clock::now();
+            (dpLangevin.*method.integrate)(rng);
+            const auto t_end = std::chrono::steady_clock::now();
+            const auto seconds
+                = std::chrono::duration<double>(t_end - t_start).count();
+            step_times.push_back(seconds);
+            total_seconds += seconds;
+        }
+        // Fraction of cells active at the end of the round
+        auto n_active = 0;
+        for (auto i=0; i<p.n_cells; i++)
+        {
+            if (dpLangevin.get_density_grid_value(i)>0) { n_active++; }
+        }
+        active_fraction_sum += n_active/static_cast<double>(p.n_cells);
+        n_rounds++;
+    }
+
+    const auto n_steps = static_cast<int>(step_times.size());
+    const auto mean_step_seconds = total_seconds/n_steps;
+    const auto min_step_seconds
+        = *std::min_element(step_times.begin(), step_times.end());
+    const auto median_step_seconds = median(step_times);
+    const auto n_working_set_bytes
+        = static_cast<size_t>(method.n_grids)*p.n_cells*sizeof(real_t);
+    const auto n_threads 
+        = (method.is_threaded) ? thread_pool.get_n_threads() : 1;
+
+    json << "    {";
+    json << "\"grid_dimension\": \"" << p.report(grid_dimension) << "\", ";
+    json << "\"grid_size\": [";
+    for (size_t i=0; i<grid_size.size(); i++)
+    {
+        json << (i==0 ? "" : ", ") << grid_size[i];
+    }
+    json << "], ";
+    json << "\"n_cells\": " << p.n_cells << ", ";
+    json << "\"grid_topologies\": \""
+        << p.report(grid_dimension, grid_topologies) << "\", ";
+    json << "\"precision\": \""
+        << ((sizeof(real_t)==sizeof(float)) ? "float32" : "float64") << "\", ";
+    json << "\"regime\": \"" << regime.name << "\", ";
+    json << "\"linear\": " << linear << ", ";
+    json << "\"method\": \"" << method.name << "\", ";
+    json << "\"n_threads\": " << n_threads << ", ";
+    json << "\"working_set_bytes\": " << n_working_set_bytes << ", ";
+    json << "\"residency\": \"" << residency(n_working_set_bytes) << "\", ";
+    json << "\"n_steps\": " << n_steps << ", ";
+    json << "\"median_step_seconds\": " << median_step_seconds << ", ";
+    json << "\"mean_step_seconds\": " << mean_step_seconds << ", ";
+    json << "\"min_step_seconds\": " << min_step_seconds << ", ";
+    json << "\"cell_updates_per_second\": "
+        << p.n_cells/median_step_seconds << ", ";
+    json << "\"active_fraction\": " << active_fraction_sum/n_rounds;
+    json << "}";
+
+    std::fprintf(
+        stderr, "%s %-26s %-13s %-11s %8d cells  %8.2f Mcells/s\n",
+        p.report(grid_dimension).c_str(),
+        p.report(grid_dimension, grid_topologies).c_str(),
+        regime.name, method.name, p.n_cells,
+        p.n_cells/median_step_seconds/1e6
+    );
+}
+
+int main(int argc, char** argv)
+{
+    const std::string path = (argc>1) ? argv[1] : "-";
+    const int n_threads = (argc>2) ? std::atoi(argv[2]) : 1;
+    const double min_seconds = (argc>3) ? std::atof(argv[3]) : 0.5;
+    ThreadPool thread_pool(n_threads);
+    const auto random_generator = (thread_pool.get_n_threads()>1)
+        ? RandomGenerator::PHILOX : RandomGenerator::MERSENNE_TWISTER;
+    const auto B = GridTopology::BOUNDED;
+    const auto P = GridTopology::PERIODIC;
+
+    // Linear coefficients of the near-critical regime lie just above the
+    // critical values found for these coefficients, dx and dt
+    const std::vector<Regime> regimes = {
+        {"active", 2.0, 1.0, 1.0},
+        {"near_critical", 1.38, 0.77, 0.05},
+    };
+    const std::vector<Method> methods = {
+        {
+            "euler", IntegrationMethod::EULER,
+            &BaseLangevin::integrate_euler, 2, true
+        },
+        {
+            "rk4", IntegrationMethod::RUNGE_KUTTA,
+            &BaseLangevin::integrate_rungekutta, 6, true
+        },
+        // The blocked wavefront needs no k3 grid, and is sequential
+        {
+            "rk4_blocked", IntegrationMethod::RUNGE_KUTTA_BLOCKED,
+            &BaseLangevin::integrate_rungekutta_blocked, 5, false
+        },
+    };
+    // Side lengths of square 2D grids; 1D grids have the same cell counts
+    const int_vec_t grid_sides = {32, 128, 512, 2048};
+    const std::vector<gt_vec_t> topologies_1d = {{P}, {B}};
+    const std::vector<gt_vec_t> topologies_2d = {{P, P}, {P, B}, {B, P}, {B, B}};
+
+    const auto now = std::time(nullptr);
+    char timestamp[32];
+    std::strftime(
+        timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now)
+    );
+    std::ostringstream json;
+    json << std::setprecision(17);
+    json << "{\n";
+    json << "  \"format\": \"dplvn-bench\",\n";
+    json << "  \"version\": 1,\n";
+    json << "  \"timestamp\": \"" << timestamp << "\",\n";
+    json << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+    json << "  \"n_threads\": " << thread_pool.get_n_threads() << ",\n";
+    json << "  \"random_generator\": \""
+        << ((random_generator==RandomGenerator::PHILOX)
+            ? "philox" : "mersenne_twister") << "\",\n";
+    json << "  \"min_seconds\": " << min_seconds << ",\n";
+    json << "  \"n_round_steps\": " << n_round_steps << ",\n";
+    json << "  \"quadratic\": " << quadratic << ",\n";
+    json << "  \"diffusion\": " << diffusion << ",\n";
+    json << "  \"noise\": " << noise << ",\n";
+    json << "  \"dx\": " << dx << ",\n";
+    json << "  \"dt\": " << dt << ",\n";
+    json << "  \"results\": [\n";
+    auto is_first = true;
+    auto bench = [&](
+        const GridDimension grid_dimension,
+        const int_vec_t& grid_size,
+        const gt_vec_t& grid_topologies
+    )
+    {
+        for (const auto& regime : regimes)
+        {
+            for (const auto& method : methods)
+            {
+                json << (is_first ? "" : ",\n");
+                is_first = false;
+                bench_case<double>(
+                    grid_dimension, grid_size, grid_topologies,
+                    regime, method, random_generator, thread_pool,
+                    min_seconds, json
+                );
+            }
+        }
+    };
+    for (const auto n_side : grid_sides)
+    {
+        for (const auto& grid_topologies : topologies_1d)
+        {
+            bench(GridDimension::D1, {n_side*n_side}, grid_topologies);
+        }
+        for (const auto& grid_topologies : topologies_2d)
+        {
+            bench(GridDimension::D2, {n_side, n_side}, grid_topologies);
+        }
+    }
+    json << "\n  ]\n";
+    json << "}\n";
+
+    const auto text = json.str();
+    if (path=="-")
+    {
+        std::cout << text;
+        return 0;
+    }
+    auto file = std::fopen(path.c_str(), "w");
+    if (not file)
+    {
+        std::fprintf(stderr, "bench_suite: couldn't create %s\n", path.c_str());
+        return 1;
+    }
+    const auto did_write = (
+        std::fwrite(text.data(), 1, text.size(), file)==text.size()
+    );
+    return (std::fclose(file)==0 and did_write) ? 0 : 1;
+}
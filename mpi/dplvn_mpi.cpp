@@ -0,0 +1,275 @@
+/**
+ * @file dplvn_mpi.cpp
+ * @brief Integration of the DP Langevin equation on a 2D grid decomposed
+ * into slabs of rows across MPI processes.
+ *
+ * Each rank integrates one slab of the grid (see GridDomain), exchanging
+ * one-row halos with the ranks holding the neighboring slabs before every
+ * Runge-Kutta stage (or Euler step), and contributing to a global sum
+ * of the density at the end of each step. The stochastic step draws from
+ * Philox per-cell streams keyed on each cell's index in the whole grid,
+ * and each slab skips the initial-condition draws of the slabs before it:
+ * so the result is the same however many ranks (and threads) share the
+ * work, and the same as an undecomposed run with Philox.
+ * Only grid size is limited by the memory of the whole set of processes.
+ *
+ * Built only when the `mpi` Meson option is enabled, and run, e.g., as:
+ *
+ *     meson setup build -Dmpi=true; meson compile -C build
+ *     mpirun -np 4 ./build/dplvn_mpi --n_x=4096 --n_y=4096 --t_final=10
+ *
+ * Options, given as `--name=value`, with their defaults:
+ *   - grid: n_x=512, n_y=512, x_edges=periodic, y_edges=periodic
+ *     (as for `grid_topologies`: periodic "x edges" wrap the grid along y),
+ *     precision=float64
+ *   - model: linear=1, quadratic=2, diffusion=0.1, noise=1
+ *   - integration: t_final=10, dx=0.5, dt=0.01, random_seed=1,
+ *     method=rk (or euler), n_threads=1 (per rank)
+ *   - initial condition: ic=uniform with ic_min=0, ic_max=1;
+ *     or ic=seed with seed_density=1, seed_x=n_x/2, seed_y=n_y/2
+ *   - output: out=dplvn_mpi
+ *
+ * Grid edges are floating. Rank 0 streams the epochs' times and mean
+ * densities to `<out>.json` and `<out>_series.bin` (see SimDPStream), and
+ * all ranks together write the final density grid to `<out>_density.bin`,
+ * as n_y rows of n_x raw values at grid precision.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "dplangevin.hpp"
+#include "langevin_mpi.hpp"
+#include "sim_dplangevin_stream.hpp"
+
+//! Type for the command-line options, by name
+typedef std::map<std::string, std::string> options_t;
+
+//! Value of a numerical option, or its default
+static double option(
+    const options_t& options, const std::string& name, const double value
+)
+{
+    const auto entry = options.find(name);
+    return (entry==options.end()) ? value : std::atof(entry->second.c_str());
+}
+
+//! Value of a text option, or its default
+static std::string option(
+    const options_t& options, const std::string& name, const char* value
+)
+{
+    const auto entry = options.find(name);
+    return (entry==options.end()) ? std::string(value) : entry->second;
+}
+
+//! Whether `is_ok` holds on every rank
+static bool all_ok(MPI_Comm comm, const bool is_ok)
+{
+    int is_ok_here = is_ok ? 1 : 0, is_ok_everywhere = 0;
+    MPI_Allreduce(
+        &is_ok_here, &is_ok_everywhere, 1, MPI_INT, MPI_MIN, comm
+    );
+    return (is_ok_everywhere==1);
+}
+
+//! Set up this rank's slab, integrate it, and write the results
+template<typename real_t>
+int run(const options_t& options, MPI_Comm comm)
+{
+    int i_rank, n_ranks;
+    MPI_Comm_rank(comm, &i_rank);
+    MPI_Comm_size(comm, &n_ranks);
+    auto fail = [&](const char* reason) -> int
+    {
+        if (i_rank==0)
+        {
+            std::fprintf(stderr, "dplvn_mpi failure: %s\n", reason);
+        }
+        return 1;
+    };
+
+    const auto n_x = static_cast<int>(option(options, "n_x", 512));
+    const auto n_y = static_cast<int>(option(options, "n_y", 512));
+    auto topology = [&](const std::string& name)
+    {
+        return (option(options, name, "periodic")=="bounded")
+            ? GridTopology::BOUNDED : GridTopology::PERIODIC;
+    };
+    const gt_vec_t grid_topologies = {topology("x_edges"), topology("y_edges")};
+    const auto is_euler = (option(options, "method", "rk")=="euler");
+    const auto is_seeded = (option(options, "ic", "uniform")=="seed");
+    const auto ic_values = is_seeded
+        ? dbl_vec_t({
+            option(options, "seed_density", 1.0),
+            option(options, "seed_x", n_x/2),
+            option(options, "seed_y", n_y/2)
+        })
+        : dbl_vec_t({
+            option(options, "ic_min", 0.0), option(options, "ic_max", 1.0)
+        });
+    const Coefficients coefficients(
+        option(options, "linear", 1.0),
+        option(options, "quadratic", 2.0),
+        option(options, "diffusion", 0.1),
+        option(options, "noise", 1.0)
+    );
+    const GridDomain domain(n_y, i_rank, n_ranks);
+    // Parameters of this rank's slab of the grid
+    const Parameters p(
+        option(options, "t_final", 10.0),
+        option(options, "dx", 0.5),
+        option(options, "dt", 0.01),
+        static_cast<int>(option(options, "random_seed", 1)),
+        GridDimension::D2, {n_x, domain.n_rows()}, grid_topologies,
+        bc_vec_t(4, BoundaryCondition::FLOATING), dbl_vec_t(4, 0.0),
+        is_seeded ? InitialCondition::SINGLE_SEED
+            : InitialCondition::RANDOM_UNIFORM,
+        ic_values,
+        is_euler ? IntegrationMethod::EULER : IntegrationMethod::RUNGE_KUTTA,
+        RandomGenerator::PHILOX,
+        (sizeof(real_t)==sizeof(float)) ? Precision::FLOAT32 : Precision::FLOAT64
+    );
+
+    MPIHaloExchanger halo_exchanger(
+        comm, domain, grid_topologies[0]==GridTopology::PERIODIC
+    );
+    ThreadPool thread_pool(static_cast<int>(option(options, "n_threads", 1)));
+    rng_t rng(p.random_seed);
+    DPLangevin<real_t> dpLangevin(p);
+    dpLangevin.set_thread_pool(&thread_pool);
+    if (not all_ok(comm, dpLangevin.set_domain(domain, &halo_exchanger)))
+    {
+        return fail("each rank must hold at least two rows of the grid");
+    }
+    if (not all_ok(comm, dpLangevin.construct_grid(p)))
+    {
+        return fail("unable to construct grid");
+    }
+    if (not dpLangevin.check_boundary_conditions(p))
+    {
+        return fail("wrong number of boundary conditions");
+    }
+    dpLangevin.plan_boundary_conditions(p);
+    if (not all_ok(comm, dpLangevin.initialize_grid(p, rng)))
+    {
+        return fail("bad initial condition");
+    }
+    dpLangevin.prepare(coefficients);
+
+    const auto n_steps = static_cast<int>(std::ceil(p.t_final/p.dt - 1e-9));
+    const auto path_stem = option(options, "out", "dplvn_mpi");
+    SimDPStream stream;
+    auto is_streaming = true;
+    if (i_rank==0)
+    {
+        const attributes_t attributes = {
+            {"linear", coefficients.linear},
+            {"quadratic", coefficients.quadratic},
+            {"diffusion", coefficients.diffusion},
+            {"noise", coefficients.noise},
+            {"t_final", p.t_final},
+            {"dx", p.dx},
+            {"dt", p.dt},
+            {"random_seed", p.random_seed},
+            {"n_x", n_x},
+            {"n_y", n_y},
+            {"n_epochs", n_steps+1},
+            {"n_ranks", n_ranks},
+        };
+        is_streaming = stream.open(path_stem, n_y, n_x, attributes);
+    }
+    if (not all_ok(comm, is_streaming))
+    {
+        return fail("couldn't create output files");
+    }
+
+    // Integrate, recording the mean density of the whole grid every epoch
+    void (BaseLangevin::*integrator)(rng_t&) = is_euler
+        ? &BaseLangevin::integrate_euler : &BaseLangevin::integrate_rungekutta;
+    dpLangevin.apply_boundary_conditions(0);
+    if (i_rank==0) { stream.write_epoch(0, 0.0, dpLangevin.get_mean_density()); }
+    MPI_Barrier(comm);
+    const auto t_start = std::chrono::steady_clock::now();
+    for (auto i=1; i<=n_steps; i++)
+    {
+        if (i==1) { dpLangevin.apply_boundary_conditions(i); }
+        (dpLangevin.*integrator)(rng);
+        if (i_rank==0)
+        {
+            stream.write_epoch(i, i*p.dt, dpLangevin.get_mean_density());
+        }
+    }
+    MPI_Barrier(comm);
+    const auto seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - t_start
+    ).count();
+    const auto did_close = (i_rank==0) ? stream.close() : true;
+
+    // Each rank writes its own rows of the final density grid
+    std::vector<real_t> slab(p.n_cells);
+    for (auto i=0; i<p.n_cells; i++)
+    {
+        slab[i] = static_cast<real_t>(dpLangevin.get_density_grid_value(i));
+    }
+    const auto density_path = path_stem + "_density.bin";
+    MPI_File file;
+    auto did_write = (MPI_File_open(
+        comm, density_path.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY,
+        MPI_INFO_NULL, &file
+    )==MPI_SUCCESS);
+    if (did_write)
+    {
+        MPI_File_set_size(file, 0);
+        const auto offset = static_cast<MPI_Offset>(domain.y_begin)*n_x*sizeof(real_t);
+        did_write = (MPI_File_write_at_all(
+            file, offset, slab.data(), p.n_cells,
+            (sizeof(real_t)==sizeof(float)) ? MPI_FLOAT : MPI_DOUBLE,
+            MPI_STATUS_IGNORE
+        )==MPI_SUCCESS);
+        MPI_File_close(&file);
+    }
+    if (not all_ok(comm, did_close and did_write))
+    {
+        return fail("couldn't write output files");
+    }
+
+    if (i_rank==0)
+    {
+        std::printf(
+            "%d x %d grid on %d ranks: %d steps in %.3fs, %.2f Mcells/s;"
+            " final mean density %.6g\n",
+            n_x, n_y, n_ranks, n_steps, seconds,
+            static_cast<double>(n_x)*n_y*n_steps/seconds/1e6,
+            dpLangevin.get_mean_density()
+        );
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    options_t options;
+    for (auto i=1; i<argc; i++)
+    {
+        const std::string argument(argv[i]);
+        const auto i_equals = argument.find('=');
+        if (argument.compare(0, 2, "--")!=0 or i_equals==std::string::npos)
+        {
+            std::fprintf(stderr, "dplvn_mpi: ignoring %s\n", argv[i]);
+            continue;
+        }
+        options[argument.substr(2, i_equals-2)] = argument.substr(i_equals+1);
+    }
+    const auto status = (option(options, "precision", "float64")=="float32")
+        ? run<float>(options, MPI_COMM_WORLD)
+        : run<double>(options, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return status;
+}
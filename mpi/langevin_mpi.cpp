@@ -0,0 +1,56 @@
+/**
+ * @file langevin_mpi.cpp
+ * @brief Halo exchange over MPI between the processes integrating the slabs
+ * of a decomposed grid.
+ */
+
+#include "langevin_mpi.hpp"
+
+MPIHaloExchanger::MPIHaloExchanger(
+    MPI_Comm comm, const GridDomain& domain, const bool is_periodic_y
+) : comm(comm)
+{
+    const auto i = domain.i_domain;
+    const auto n = domain.n_domains;
+    rank_below = (i>0) ? i-1 : (is_periodic_y ? n-1 : MPI_PROC_NULL);
+    rank_above = (i<n-1) ? i+1 : (is_periodic_y ? 0 : MPI_PROC_NULL);
+}
+
+//! Send this slab's first row to the slab below while receiving the first
+//! row of the slab above into the upper halo row, and then likewise its
+//! last row to the slab above, receiving into the lower halo row
+template<typename real_t>
+void MPIHaloExchanger::exchange_rows(
+    real_t* grid, const int n_x, const int n_cells, MPI_Datatype datatype
+)
+{
+    real_t* const halo_below = grid + n_cells;
+    real_t* const halo_above = grid + n_cells + n_x;
+    MPI_Sendrecv(
+        grid, n_x, datatype, rank_below, 0,
+        halo_above, n_x, datatype, rank_above, 0,
+        comm, MPI_STATUS_IGNORE
+    );
+    MPI_Sendrecv(
+        grid + n_cells - n_x, n_x, datatype, rank_above, 1,
+        halo_below, n_x, datatype, rank_below, 1,
+        comm, MPI_STATUS_IGNORE
+    );
+}
+
+void MPIHaloExchanger::exchange(float* grid, const int n_x, const int n_cells)
+{
+    exchange_rows(grid, n_x, n_cells, MPI_FLOAT);
+}
+
+void MPIHaloExchanger::exchange(double* grid, const int n_x, const int n_cells)
+{
+    exchange_rows(grid, n_x, n_cells, MPI_DOUBLE);
+}
+
+double MPIHaloExchanger::sum(const double value)
+{
+    double total = 0;
+    MPI_Allreduce(&value, &total, 1, MPI_DOUBLE, MPI_SUM, comm);
+    return total;
+}
@@ -0,0 +1,47 @@
+/**
+ * @file langevin_mpi.hpp
+ * @brief Halo exchange over MPI between the processes integrating the slabs
+ * of a decomposed grid.
+ */
+
+#ifndef LANGEVIN_MPI_HPP
+#define LANGEVIN_MPI_HPP
+
+#include <mpi.h>
+#include "langevin_domain.hpp"
+
+/**
+ * @brief Halo exchange over MPI between the processes integrating the slabs
+ * of a decomposed grid, one slab per rank in rank order up the y axis.
+ *
+ * Each exchange is a pair of MPI_Sendrecv calls, passing every slab's
+ * first row down and its last row up at once. Across bounded y edges of
+ * the whole grid, the first and last slabs have no neighbor, and their
+ * outer halo rows are left untouched (they aren't wired to any cell).
+ */
+class MPIHaloExchanger : public HaloExchanger
+{
+private:
+    //! Communicator of the processes sharing the grid
+    MPI_Comm comm;
+    //! Ranks holding the slabs below and above this one (or MPI_PROC_NULL)
+    int rank_below, rank_above;
+
+    //! Swap edge rows with the neighboring slabs
+    template<typename real_t>
+    void exchange_rows(
+        real_t* grid, const int n_x, const int n_cells, MPI_Datatype datatype
+    );
+
+public:
+    //! Constructor: neighbors follow from the slab's index, and wrap around
+    //! if the grid's y edges are periodic
+    MPIHaloExchanger(
+        MPI_Comm comm, const GridDomain& domain, const bool is_periodic_y
+    );
+    void exchange(float* grid, const int n_x, const int n_cells) override;
+    void exchange(double* grid, const int n_x, const int n_cells) override;
+    double sum(const double value) override;
+};
+
+#endif
@@ -1,59 +1,77 @@
 /**
  * @file dplangevin.cpp
  * @brief Redefinition of BaseLangevin constructor; implementation of stub methods.
+ *
+ * The DP Langevin RHS itself is defined inline in dplangevin.hpp.
  */
 
-#include <pybind11/numpy.h>
 #include <string>
 #include "dplangevin.hpp"
 
 /**
  * @brief Redefinition of BaseLangevin class constructor
+ *
+ * The base classes take local copies of the parameters and allocate grids.
  */
-DPLangevin::DPLangevin(Parameters p)
-{
-    // "Local" copies
-    n_cells = p.n_cells;
-    dt = p.dt;
-    dx = p.dx;
-    // The Langevin density field grid as a 1d vector
-    density_grid = grid_t(n_cells, 0.0); 
-    // Supplementary grids (as 1d vectors of same length)
-    aux_grid1 = grid_t(n_cells, 0.0);
-    aux_grid2 = grid_t(n_cells, 0.0);
-    k1_grid = grid_t(n_cells, 0.0);
-    k2_grid = grid_t(n_cells, 0.0);
-    k3_grid = grid_t(n_cells, 0.0);
-}
+template<typename real_t>
+DPLangevin<real_t>::DPLangevin(const Parameters& p) : 
+    LangevinModel<DPLangevin<real_t>, real_t>(p)
+{}
 
 //! Method to set nonlinear coefficients in DP Langevin equation 
 //! for deterministic integration step
-void DPLangevin::set_nonlinear_coefficients(const Coefficients& coefficients)
+template<typename real_t>
+void DPLangevin<real_t>::set_nonlinear_coefficients(
+    const Coefficients& coefficients
+)
 {
+    const auto dx = this->dx;
     quadratic_coefficient = coefficients.quadratic;
     diffusion_coefficient = coefficients.diffusion / (dx*dx);
 }
 
-//! Method to set nonlinear RHS of DP Langevin equation 
-//! for deterministic integration step
-double DPLangevin::nonlinear_rhs(const int i_cell, const grid_t& grid) const
+//! Bound on the decay rate of the fastest mode of the deterministic step:
+//! the discrete Laplacian's largest eigenvalue magnitude, 4 D/Δx² per grid
+//! dimension. The nonlinear term -bρ² is left out: it is dissipative, and
+//! its rate 2bρ is small next to diffusion whenever Δx is small enough for
+//! diffusion to limit Δt at all.
+template<typename real_t>
+double DPLangevin<real_t>::get_stiffness() const
 {
-    // Non-linear term, which is quadratic in the DP Langevin equation
-    const double quadratic_term 
-        = -quadratic_coefficient*grid[i_cell]*grid[i_cell];
+    return 4*static_cast<int>(this->grid_dimension)*diffusion_coefficient;
+}
 
-    // For integration of diffusion
-    double diffusion_sum = 0.0;
-    const neighborhood_t& cell_wiring = grid_wiring[i_cell];
-    for (auto j_wire=0; j_wire<cell_wiring.size(); j_wire++)
-    {
-        const auto j_neighbor_cell = cell_wiring[j_wire];
-        diffusion_sum += grid[j_neighbor_cell];
-    }
-    const auto diffusion_term = (
-        diffusion_coefficient*(diffusion_sum 
-            - cell_wiring.size()*grid[i_cell])
-    );
-    // Combine terms
-    return diffusion_term + quadratic_term;
+template<typename real_t>
+double DPLangevin<real_t>::get_diffusion_rate() const
+{
+    return diffusion_coefficient;
 }
+
+//! The DP Langevin RHS less diffusion is just the quadratic term -bρ²
+template<typename real_t>
+void DPLangevin<real_t>::reaction_rhs_block(
+    const grid_t& field, const int i_begin, const int i_end, grid_t& rhs
+) const
+{
+    const auto b = static_cast<real_t>(quadratic_coefficient);
+    for (auto i=i_begin; i<i_end; i++) { rhs[i] = -b*field[i]*field[i]; }
+}
+
+template DPLangevin<float>::DPLangevin(const Parameters&);
+template DPLangevin<double>::DPLangevin(const Parameters&);
+template void DPLangevin<float>::set_nonlinear_coefficients(
+    const Coefficients&
+);
+template void DPLangevin<double>::set_nonlinear_coefficients(
+    const Coefficients&
+);
+template double DPLangevin<float>::get_stiffness() const;
+template double DPLangevin<double>::get_stiffness() const;
+template double DPLangevin<float>::get_diffusion_rate() const;
+template double DPLangevin<double>::get_diffusion_rate() const;
+template void DPLangevin<float>::reaction_rhs_block(
+    const grid_t&, const int, const int, grid_t&
+) const;
+template void DPLangevin<double>::reaction_rhs_block(
+    const grid_t&, const int, const int, grid_t&
+) const;
@@ -7,18 +7,25 @@
 #define DPLANGEVIN_HPP
 
 #include "langevin_types.hpp"
-#include "langevin_base.hpp"
+#include "langevin_model.hpp"
 
 /**
  * @brief DPLangevin model application of BaseLangevin class integrator.
+ *
+ * Derived via the CRTP helper LangevinModel so that the integrators' 
+ * block-wise RHS sweeps call the inline `cell_rhs` directly.
+ * Instantiated for density grids of double and of float precision.
  */
-class DPLangevin : public BaseLangevin 
+template<typename real_t>
+class DPLangevin final : public LangevinModel<DPLangevin<real_t>, real_t> 
 {
 public:
+    typedef typename Langevin<real_t>::grid_t grid_t;
+
     //! Constructor assuming default model parameters
     DPLangevin() = default;
     //! Constructor when model parameters are passed by the user
-    DPLangevin(Parameters p);
+    DPLangevin(const Parameters& p);
 
     //! Coefficient in nonlinear term -bρ² in DP-Langevin equation
     double quadratic_coefficient;
@@ -26,9 +33,48 @@ public:
     double diffusion_coefficient;
     
     //! Method to set nonlinear coefficients for deterministic integration step
-    void set_nonlinear_coefficients(const Coefficients& coefficients);
+    void set_nonlinear_coefficients(const Coefficients& coefficients) override;
+    //! Method to bound the decay rate of the fastest diffusive mode
+    double get_stiffness() const override;
+    //! Method to give the diffusion coefficient over Δx²
+    double get_diffusion_rate() const override;
     //! Method to set nonlinear RHS of Langevin equation for deterministic integration step
-    double nonlinear_rhs(const int i_cell, const grid_t& density) const;
+    inline real_t cell_rhs(const int i_cell, const grid_t& grid) const;
+    //! Method to evaluate nonlinear RHS over a block of cells, using a vectorized stencil for 2D and 3D grid-interior cells
+    void nonlinear_rhs_block(
+        const grid_t& field, const int i_begin, const int i_end, grid_t& rhs
+    ) const override;
+    //! Method to evaluate the nonlinear RHS less diffusion, -bρ², over a block of cells
+    void reaction_rhs_block(
+        const grid_t& field, const int i_begin, const int i_end, grid_t& rhs
+    ) const override;
 };
 
+//! Method to set nonlinear RHS of DP Langevin equation 
+//! for deterministic integration step, at grid precision
+template<typename real_t>
+inline real_t DPLangevin<real_t>::cell_rhs(
+    const int i_cell, const grid_t& grid
+) const
+{
+    const grid_wiring_t& grid_wiring = *this->grid_wiring;
+    // Non-linear term, which is quadratic in the DP Langevin equation
+    const real_t quadratic_term 
+        = -static_cast<real_t>(quadratic_coefficient)*grid[i_cell]*grid[i_cell];
+
+    // For integration of diffusion
+    real_t diffusion_sum = 0;
+    const int* const wires_end = grid_wiring.end(i_cell);
+    for (auto wire = grid_wiring.begin(i_cell); wire<wires_end; wire++)
+    {
+        diffusion_sum += grid[*wire];
+    }
+    const real_t diffusion_term = (
+        static_cast<real_t>(diffusion_coefficient)*(diffusion_sum 
+            - grid_wiring.n_neighbors(i_cell)*grid[i_cell])
+    );
+    // Combine terms
+    return diffusion_term + quadratic_term;
+}
+
 #endif
@@ -0,0 +1,166 @@
+/**
+ * @file dplangevin_stencil.cpp
+ * @brief Vectorized fast path for the DP Langevin RHS on 2D and 3D grid interiors.
+ */
+
+#include <algorithm>
+#include "dplangevin.hpp"
+
+// Where the compiler and platform support it, build the interior-row kernels
+// several times over for different x86 instruction sets and let the loader
+// pick the best one for the CPU at hand; otherwise build a single portable
+// version and leave vectorization to the compiler's default target.
+#if defined(__has_attribute)
+#  if __has_attribute(target_clones) && defined(__x86_64__) \
+    && defined(__linux__)
+#    define DP_TARGET_CLONES \
+        __attribute__((target_clones("avx512f", "avx2", "default")))
+#  endif
+#endif
+#ifndef DP_TARGET_CLONES
+#  define DP_TARGET_CLONES
+#endif
+
+/**
+ * @details 
+ * DP Langevin RHS D*(Σneighbors - 4ρ) - bρ² along a run of `n` grid-interior
+ * cells in one row, starting at `field`. All four neighbors are reached by 
+ * fixed offsets (±1 along x, ±`n_x` along y), so every load is unit-stride 
+ * and the loop vectorizes. Terms are summed in the same order as the wired
+ * (per-cell) evaluation in DPLangevin::cell_rhs. In single precision,
+ * each SIMD register holds twice as many cells.
+ */
+template<typename real_t>
+DP_TARGET_CLONES
+static void dp_rhs_interior_run(
+    const real_t* field, const int n_x, const int n, real_t* __restrict rhs,
+    const real_t diffusion_coefficient, const real_t quadratic_coefficient
+)
+{
+    const real_t* const above = field + n_x;
+    const real_t* const below = field - n_x;
+    for (auto i=0; i<n; i++)
+    {
+        const real_t diffusion_sum 
+            = above[i] + below[i] + field[i+1] + field[i-1];
+        const real_t quadratic_term 
+            = -quadratic_coefficient*field[i]*field[i];
+        rhs[i] 
+            = diffusion_coefficient*(diffusion_sum - 4*field[i]) 
+                + quadratic_term;
+    }
+}
+
+/**
+ * @details 
+ * As above, but for a run of cells in one row of a 3D grid, using the
+ * 7-point stencil D*(Σneighbors - 6ρ) - bρ²: the neighbors in the adjacent
+ * z-planes are reached by offsets of ±`n_xy` = ±n_x*n_y. Terms are summed
+ * in the order of the wiring set up in construct_3D_grid.
+ */
+template<typename real_t>
+DP_TARGET_CLONES
+static void dp_rhs_interior_run_3d(
+    const real_t* field, const int n_x, const int n_xy, const int n, 
+    real_t* __restrict rhs,
+    const real_t diffusion_coefficient, const real_t quadratic_coefficient
+)
+{
+    const real_t* const front = field + n_xy;
+    const real_t* const back = field - n_xy;
+    const real_t* const above = field + n_x;
+    const real_t* const below = field - n_x;
+    for (auto i=0; i<n; i++)
+    {
+        const real_t diffusion_sum 
+            = front[i] + back[i] + above[i] + below[i] 
+                + field[i+1] + field[i-1];
+        const real_t quadratic_term 
+            = -quadratic_coefficient*field[i]*field[i];
+        rhs[i] 
+            = diffusion_coefficient*(diffusion_sum - 6*field[i]) 
+                + quadratic_term;
+    }
+}
+
+/**
+ * @details 
+ * Evaluate the DP Langevin RHS over cells i_begin...i_end-1, walking the 
+ * block row by row. On 2D and 3D grids, the interior cells of each interior
+ * row are handed to the vectorized kernels above; only the edge rows and 
+ * columns (and in 3D the edge planes), whose neighbors depend on the grid 
+ * topology, are evaluated cell by cell via the grid wiring set up in 
+ * construct_2D_grid or construct_3D_grid. 
+ * Since a 3D block is a band of rows of a single z-plane, the planes
+ * above and below it are swept in step, and stay in cache for the next
+ * block of the sweep, which is the same band of the next plane.
+ * 1D grids are evaluated entirely via the grid wiring.
+ */
+template<typename real_t>
+void DPLangevin<real_t>::nonlinear_rhs_block(
+    const grid_t& field, const int i_begin, const int i_end, grid_t& rhs
+) const
+{
+    if (this->grid_dimension==GridDimension::D1)
+    {
+        LangevinModel<DPLangevin<real_t>, real_t>::nonlinear_rhs_block(
+            field, i_begin, i_end, rhs
+        );
+        return;
+    }
+    const auto n_x = this->n_x;
+    const auto n_y = this->n_y;
+    const auto n_z = this->n_z;
+    const auto n_xy = n_x*n_y;
+    const auto is_3d = (this->grid_dimension==GridDimension::D3);
+    // Topology-aware, per-cell evaluation
+    auto wired_rhs = [&](const int i0, const int i1)
+    {
+        for (auto i=i0; i<i1; i++) { rhs[i] = cell_rhs(i, field); }
+    };
+
+    auto i = i_begin;
+    while (i<i_end)
+    {
+        const auto row = i / n_x;
+        const auto y = row % n_y;
+        const auto z = row / n_y;
+        const auto i_row = row*n_x;
+        const auto i_row_end = std::min(i_row+n_x, i_end);
+        if (y==0 or y==n_y-1 or (is_3d and (z==0 or z==n_z-1)))
+        {
+            // Edge row
+            wired_rhs(i, i_row_end);
+        }
+        else
+        {
+            // Interior row: edge cells at x=0 and x=n_x-1 are wired
+            const auto i0 = std::min(std::max(i, i_row+1), i_row_end);
+            const auto i1 = std::max(std::min(i_row_end, i_row+n_x-1), i0);
+            wired_rhs(i, i0);
+            if (i1>i0 and is_3d) 
+            {
+                dp_rhs_interior_run_3d<real_t>(
+                    &field[i0], n_x, n_xy, i1-i0, &rhs[i0], 
+                    diffusion_coefficient, quadratic_coefficient
+                );
+            }
+            else if (i1>i0) 
+            {
+                dp_rhs_interior_run<real_t>(
+                    &field[i0], n_x, i1-i0, &rhs[i0], 
+                    diffusion_coefficient, quadratic_coefficient
+                );
+            }
+            wired_rhs(i1, i_row_end);
+        }
+        i = i_row_end;
+    }
+}
+
+template void DPLangevin<float>::nonlinear_rhs_block(
+    const grid_t&, const int, const int, grid_t&
+) const;
+template void DPLangevin<double>::nonlinear_rhs_block(
+    const grid_t&, const int, const int, grid_t&
+) const;
@@ -6,35 +6,60 @@
 #ifndef BASE_HPP
 #define BASE_HPP
 
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <utility>
 #include "langevin_coefficients.hpp"
+#include "langevin_domain.hpp"
 #include "langevin_parameters.hpp"
+#include "langevin_threads.hpp"
+#include "langevin_tridiagonal.hpp"
+#include "langevin_wiring_cache.hpp"
 
 /**
  * @brief Base class for Langevin equation integrator.
+ *
+ * Holds everything that doesn't depend on the floating-point precision 
+ * of the density field: the grid shape and wiring, its partition into
+ * blocks, the time step and Dornic coefficients, and the random number
+ * settings. The density grids themselves, and the methods that sweep 
+ * over them, are provided at a chosen precision by the derived template 
+ * Langevin<real_t>: so simulation managers can drive either through 
+ * a pointer to this class.
  */
 class BaseLangevin
 {
 protected:
     //! Total number of cells in n-D grid
     int n_cells;
-    //! Density field grid
-    grid_t density_grid;
-     //! Neighorhood topology for all grid cells
-    grid_wiring_t grid_wiring;
+    //! Density field grid dimension
+    GridDimension grid_dimension;
+    //! Number of cells along x, y, z (unused dimensions have one cell)
+    int n_x, n_y, n_z;
+    //! Neighorhood topology for all grid cells (never modified once built, and shared by integrators of identical grids)
+    std::shared_ptr<const grid_wiring_t> grid_wiring;
+    //! Slab of a 2d grid decomposed across processes (by default, the whole grid)
+    GridDomain domain;
+    //! Index in the whole grid of this slab's first cell, which keys its cells' Philox streams
+    int i_first_cell = 0;
+    //! Exchanger of halo rows with the processes integrating neighboring slabs (not owned); null => grid not decomposed
+    HaloExchanger* halo_exchanger = nullptr;
    
     //! Time step, i.e, epoch-to-epoch Δt
     double dt;
     //! Grid spacing, i.e., spacing Δx between cell centers in all directions
     double dx;
-    //! Grid-average of density field
+    //! Grid-average of density field (always accumulated in double precision)
     double mean_density;
 
-    //! Function generating Poisson variates
-    poisson_dist_t poisson_sampler;
-    //! Function generating gamma variates
-    gamma_dist_t gamma_sampler;
-    //! Function generating normal variates
-    gaussian_dist_t gaussian_sampler;
+    //! Random number generation for the stochastic step
+    RandomGenerator random_generator;
+    //! Seed (key) of counter-based random number streams
+    int random_seed;
+    //! Count of integration steps taken, used to key counter-based streams
+    std::uint64_t i_step = 0;
 
     //! Dornic method coefficient
     double linear_coefficient;
@@ -44,50 +69,190 @@ protected:
     double lambda;
     //! Dornic method stochastic-step variable
     double lambda_on_explcdt;
+    //! Dornic (lambda, lambda_on_explcdt) for each distinct time step used so far
+    std::map< double, std::pair<double, double> > lambda_cache;
+    //! Flag: estimate the local error of each Runge-Kutta step's deterministic update
+    bool do_estimate_error = false;
+    //! Per-block maxima of the scaled local error estimates of the latest step
+    dbl_vec_t block_errors;
+    //! Implicit diffusion solvers along x, y and z, factorized for Δt = diffusion_dt
+    std::vector<DiffusionLineSolver> diffusion_solvers;
+    //! Time step for which the implicit diffusion solvers were factorized (0: not yet)
+    double diffusion_dt = 0;
 
-    //! Runge-Kutta variable grid #1
-    grid_t k1_grid;
-    //! Runge-Kutta variable grid #2
-    grid_t k2_grid;
-    //! Runge-Kutta variable grid #3
-    grid_t k3_grid;
-    //! Temporary density grid used to perform an integration step
-    grid_t aux_grid1;
-    //! Temporary density grid used to perform an integration step
-    grid_t aux_grid2;
+    //! Target number of cells per block in block-wise integration sweeps
+    static const int n_block_cells = 4096;
+    //! Index of the first cell of each block of whole grid rows, plus the end
+    int_vec_t block_offsets;
+    //! Number of cells in each block (the last block of each plane may have fewer)
+    int n_cells_per_block;
+    //! Number of cells in each plane partitioned separately into blocks: the whole grid, unless the grid is 3d with large z-planes
+    int n_cells_per_plane;
+    //! Number of blocks in each plane partitioned separately
+    int n_blocks_per_plane;
+    //! Order in which blocks are swept: block index order, unless a 3d grid is tiled in y and z
+    int_vec_t block_sweep_order;
+    //! Per-block partial sums, e.g., of the density field
+    dbl_vec_t block_sums;
+    //! Neighborhood topology of blocks, derived from that of grid cells
+    grid_wiring_t block_wiring;
+    //! Flag per block: does it have any cells of nonzero density?
+    std::vector<unsigned char> block_is_occupied;
+    //! Flag per block: does it need integrating this step?
+    std::vector<unsigned char> block_is_active;
+    //! Scratch copy of block_is_active, kept to avoid reallocating it every step
+    std::vector<unsigned char> block_was_active;
+    //! Number of consecutive steps for which each block has been skipped
+    int_vec_t block_n_idle_steps;
+    //! Indexes of the blocks that need integrating this step
+    int_vec_t active_blocks;
+    //! Number of Runge-Kutta stages each block has completed in a blocked step
+    int_vec_t block_n_stages;
+    //! Pool of threads to share block-wise sweeps (not owned); null => serial
+    ThreadPool* thread_pool = nullptr;
+
+    //! An edge cell with a fixed-value or fixed-flux boundary condition
+    struct BoundaryCell
+    {
+        int i_cell;
+        BoundaryCondition boundary_condition;
+        double value;
+        //! Whether the cell is listed earlier too, as a corner of another edge
+        bool is_relisted;
+    };
+    //! Edge cells with boundary conditions, block by block, and within each block in the order the edges are treated
+    std::vector<BoundaryCell> boundary_cells;
+    //! Density of each listed edge cell before its boundary condition was last applied
+    dbl_vec_t boundary_densities;
+    //! Index into boundary_cells of the first edge cell of each block, plus the end
+    int_vec_t block_boundary_offsets;
+
+    //! Sums over the cells of one block, from which observables are computed
+    struct BlockMoments
+    {
+        double n_active = 0;
+        double density_sum = 0;
+        double density_squared_sum = 0;
+        double radius_squared_sum = 0;
+    };
+    //! Flag: gather per-block moments as blocks are integrated
+    bool do_observe = false;
+    //! Moments of each block after its latest update
+    std::vector<BlockMoments> block_moments;
+    //! Squared distance of each cell from the seed cell (only if needed)
+    dbl_vec_t cell_radii_squared;
+
+    //! Partition the grid into blocks of whole rows (or planes) for block-wise sweeps
+    void partition_grid();
+    //! Link blocks holding neighboring cells
+    void wire_blocks();
+    //! Number of blocks in the grid partition
+    int n_blocks() const;
+    //! Index of the block holding a cell
+    int block_of(const int i_cell) const;
+    //! Index in this slab's grids of a cell of the whole grid: its own, its halo cell's, or -1 if neither
+    int local_cell(const int i_global) const;
+    //! Turn the mean density of this slab into that of the whole grid
+    void reduce_mean_density();
+    //! Choose the blocks to integrate: those within n_hops links of an occupied block
+    void find_active_blocks(const int n_hops);
+    //! Apply `block_task(i_begin, i_end)` to all active blocks, in parallel if possible
+    void for_each_block(const std::function<void(int, int)>& block_task);
+    //! Whether block-wise sweeps are shared by more than one thread
+    bool is_multithreaded() const;
+    //! Factorize the implicit diffusion solvers for the current Δt
+    void factorize_diffusion();
+    //! Apply `block_task(i_begin, i_end, block_sum)` to all active blocks, in parallel if possible, and total their sums in block order
+    double sum_over_blocks(
+        const std::function<void(int, int, double&)>& block_task
+    );
 
 public:
     //! Default constructor
     BaseLangevin() = default;
+    //! Constructor taking grid shape, time step etc from the model parameters
+    BaseLangevin(const Parameters& p);
+    virtual ~BaseLangevin() = default;
+    //! Share block-wise integration sweeps across a pool of threads
+    void set_thread_pool(ThreadPool* thread_pool);
     //! Construct Langevin density field grid of appropriate n-D dimension
-    bool construct_grid(const Parameters parameters);
+    bool construct_grid(const Parameters& parameters);
+    //! Fetch the cell wiring of the constructed grid, shared with any integrators of identical grids
+    std::shared_ptr<const grid_wiring_t> get_grid_wiring() const;
     //! Build 1d Langevin density field grid & topology
-    bool construct_1D_grid(const Parameters parameters);
+    bool construct_1D_grid(const Parameters& parameters);
     //! Build 2d Langevin density field grid & mixed topology
-    bool construct_2D_grid(const Parameters parameters);
-    //! Initial condition for density field: uniformly random
-    bool initialize_grid(const Parameters parameters, rng_t& rng);
+    bool construct_2D_grid(const Parameters& parameters);
+    //! Build 3d Langevin density field grid & mixed topology
+    bool construct_3D_grid(const Parameters& parameters);
     //! Set initial condition of Langevin density field grid
     void prepare(const Coefficients& coefficients);
+    //! Change the time step Δt, along with the Dornic coefficients that depend on it
+    void set_dt(const double dt);
+    //! Fetch the time step Δt
+    double get_dt() const;
+    //! Choose whether Runge-Kutta steps estimate their local error
+    void set_error_estimation(const bool do_estimate_error);
+    //! Fetch the largest scaled local error estimate of the latest Runge-Kutta step
+    double get_step_error() const;
     //! Check we have 2N boundary conditions for an N-dimensional grid
-    bool check_boundary_conditions(const Parameters parameters);
-    //! Set density field values only the grid edges per bc specs
-    void apply_boundary_conditions(const Parameters parameters, int i_epoch);
-    //! Runge-Kutta + stochastic integration + grid update
-    void integrate_rungekutta(rng_t& rng);
-    //! Explicit Euler + stochastic integration + grid update
-    void integrate_euler(rng_t& rng);
-    double get_density_grid_value(const int) const;
+    bool check_boundary_conditions(const Parameters& parameters);
+    //! List the edge cells with non-floating boundary conditions, block by block
+    void plan_boundary_conditions(const Parameters& parameters);
     //! Expose mean density
     double get_mean_density() const;
     //! Compute Poisson RNG mean
     double get_poisson_mean() const;
+    //! Whether the grid has fallen into the absorbing (all-empty) state
+    bool is_absorbed() const;
+    //! Fetch the count of integration steps taken
+    std::uint64_t get_i_step() const;
+    //! Restore the count of integration steps taken and the grid-averaged density, e.g., from a checkpoint
+    void set_step_state(const std::uint64_t i_step, const double mean_density);
+    //! Choose observables to measure as the grid is integrated (none if empty)
+    void set_observables(
+        const Parameters& parameters, const obs_vec_t& observables
+    );
+    //! Compute an observable from the per-block moments of the latest step
+    double get_observable(const Observable observable) const;
 
     //! Method to set nonlinear coefficients for deterministic integration step: to be defined by application
     virtual void set_nonlinear_coefficients(const Coefficients& coefficients) {};
-    //! Method to set nonlinear RHS of Langevin equation for deterministic integration step: to be defined by application
-    virtual double nonlinear_rhs(const int i_cell, const grid_t& field) const 
-        { return 0; };
+    //! Diffusion coefficient over Δx², for integrators treating diffusion separately from the rest of the RHS: to be defined by application (0: no separate diffusion term)
+    virtual double get_diffusion_rate() const { return 0; };
+    //! Bound on the decay rate of the fastest mode of the deterministic RHS, which limits stable explicit time steps: to be defined by application (0: unknown)
+    virtual double get_stiffness() const { return 0; };
+
+    // Methods sweeping the density grid, at the precision of Langevin<real_t>
+
+    //! Make this integrator responsible for one slab of a 2d grid decomposed across processes, before the grid is constructed
+    virtual bool set_domain(
+        const GridDomain& domain, HaloExchanger* halo_exchanger
+    ) = 0;
+    //! Initial condition for density field: uniformly random
+    virtual bool initialize_grid(const Parameters& parameters, rng_t& rng) = 0;
+    //! Set density field values only the grid edges per bc specs, in a separate pass (integration steps apply them within their final sweep)
+    virtual void apply_boundary_conditions(const int i_epoch) = 0;
+    //! Rescale the fixed fluxes already added to the grid edges, over the current Δt, to a step of `dt_step`
+    virtual void rescale_boundary_fluxes(const double dt_step) = 0;
+    //! Runge-Kutta + stochastic integration + grid update
+    virtual void integrate_rungekutta(rng_t& rng) = 0;
+    //! Runge-Kutta + stochastic integration + grid update, block by block in a wavefront
+    virtual void integrate_rungekutta_blocked(rng_t& rng) = 0;
+    //! Explicit Euler + stochastic integration + grid update
+    virtual void integrate_euler(rng_t& rng) = 0;
+    //! Explicit Runge-Kutta reaction + implicit diffusion + stochastic integration + grid update
+    virtual void integrate_implicit(rng_t& rng) = 0;
+    //! Return the density field value at a grid cell
+    virtual double get_density_grid_value(const int) const = 0;
+    //! Flag the blocks holding any nonzero cells, and gather their moments if observing, over the whole grid
+    virtual void find_occupied_blocks() = 0;
+    //! Copy every `stride`-th cell of every `stride`-th row of the density field into `frame`
+    virtual void copy_density_grid(const int stride, double* frame) const = 0;
+    //! Write the density field grid as raw values, at grid precision, to `file`
+    virtual bool write_density_grid(std::FILE* file) const = 0;
+    //! Read the density field grid as raw values, at grid precision, from `file`
+    virtual bool read_density_grid(std::FILE* file) = 0;
 };
 
 #endif
\ No newline at end of file
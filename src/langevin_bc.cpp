@@ -3,11 +3,12 @@
  * @brief Methods for setting boundary conditions for Langevin model.
  */
 
+#include <algorithm>
 #include "langevin_types.hpp"
-#include "langevin_base.hpp"
+#include "langevin_integrator.hpp"
 
 //! Check that 2x bcs are specified for each grid dimension, one for each edge
-bool BaseLangevin::check_boundary_conditions(const Parameters p)
+bool BaseLangevin::check_boundary_conditions(const Parameters& p)
 {
     switch (p.grid_dimension)
     {
@@ -22,116 +23,236 @@ bool BaseLangevin::check_boundary_conditions(const Parameters p)
     }
 }
 
-//! Apply boundary conditions along each edge in turn 
-void BaseLangevin::apply_boundary_conditions(const Parameters p, int i_epoch)
+/**
+ * @details List the edge cells that have fixed-value or fixed-flux 
+ * boundary conditions, in the order the edges are treated (lx, ux, then
+ * in 2d ly, uy, and in 3d also lz, uz), and then sort them stably by 
+ * block: so that each integration step can apply the conditions to a 
+ * block's edge cells while it makes its final sweep over that block, 
+ * rather than in a pass of its own. Corner cells are listed once per edge
+ * they lie on, and so take the conditions of both edges in turn. 
+ * Floating edges need nothing done.
+ * In 3d the "edges" are faces: lx, ux are the y=0 and y=n_y-1 faces and
+ * ly, uy the x=0 and x=n_x-1 faces, as in 2d, and lz, uz the z=0 and 
+ * z=n_z-1 faces.
+ */
+void BaseLangevin::plan_boundary_conditions(const Parameters& p)
 {
-    auto i_from_xy = [&](int x, int y) -> int { return x + y*p.n_x; };
-    auto add_to_density = [&](int x, int y, double value)
-    {
-        density_grid[i_from_xy(x, y)] 
-            = fmax(density_grid[i_from_xy(x, y)] + value*p.dt, 0.0);
-
-    };
-    auto apply_bc_to_edge_2d = [&] (
-        GridEdge grid_edge, BoundaryCondition bc, double value
-    ) 
+    std::vector<int_vec_t> edges_cells;
+    switch (p.grid_dimension)
     {
-        if (bc==BoundaryCondition::FIXED_VALUE) 
-        {
-            switch (grid_edge)
+        case (GridDimension::D1):
+            edges_cells = {{0}, {n_x-1}};
+            break;
+        case (GridDimension::D2):
+            edges_cells.resize(4);
+            // A slab of a decomposed grid only holds the bottom (top) row
+            // of the whole grid if it's the first (last) slab
+            for (auto x=0; x<n_x; x++)
             {
-                case (GridEdge::lx):
-                    for (auto x=0; x<p.n_x; x++){
-                        density_grid[i_from_xy(x,0)] = value;
-                    }
-                    break;
-                case (GridEdge::ux):
-                    for (auto x=0; x<p.n_x; x++){
-                        density_grid[i_from_xy(x, p.n_y-1)] = value;
-                    }
-                    break;
-                case (GridEdge::ly):
-                    for (auto y=0; y<p.n_y; y++){
-                        density_grid[i_from_xy(0, y)] = value;
-                    }
-                    break;
-                case (GridEdge::uy):
-                    for (auto y=0; y<p.n_y; y++){
-                        density_grid[i_from_xy(p.n_x-1, y)] = value;
-                    }
-                    break;
+                if (domain.y_begin==0) { edges_cells[0].push_back(x); }
+                if (not domain.is_decomposed() or domain.y_end==domain.n_y_global)
+                {
+                    edges_cells[1].push_back(x + (n_y-1)*n_x);
+                }
             }
-        }
-        // Don't "add flux" if we're at epoch#0
-        else if (bc==BoundaryCondition::FIXED_FLUX and i_epoch>0) 
-        {
-            switch (grid_edge)
+            for (auto y=0; y<n_y; y++)
+            {
+                edges_cells[2].push_back(y*n_x);
+                edges_cells[3].push_back(n_x-1 + y*n_x);
+            }
+            break;
+        case (GridDimension::D3):
+            edges_cells.resize(6);
+            for (auto z=0; z<n_z; z++)
+            {
+                const auto i_plane = z*n_x*n_y;
+                for (auto x=0; x<n_x; x++)
+                {
+                    edges_cells[0].push_back(i_plane + x);
+                    edges_cells[1].push_back(i_plane + x + (n_y-1)*n_x);
+                }
+                for (auto y=0; y<n_y; y++)
+                {
+                    edges_cells[2].push_back(i_plane + y*n_x);
+                    edges_cells[3].push_back(i_plane + n_x-1 + y*n_x);
+                }
+            }
+            for (auto i=0; i<n_x*n_y; i++)
             {
-                case (GridEdge::lx):
-                    for (auto x=0; x<p.n_x; x++){
-                        auto y = 0;
-                        add_to_density(x, y, value);
-                    }
-                    break;
-                case (GridEdge::ux):
-                    for (auto x=0; x<p.n_x; x++){
-                        auto y = p.n_y-1;
-                        add_to_density(x, y, value);
-                    }
-                    break;
-                case (GridEdge::ly):
-                    for (auto y=0; y<p.n_y; y++){
-                        auto x = 0;
-                        add_to_density(x, y, value);
-                    }
-                    break;
-                case (GridEdge::uy):
-                    for (auto y=0; y<p.n_y; y++){
-                        auto x = p.n_x-1;
-                        add_to_density(x, y, value);
-                    }
-                    break;
+                edges_cells[4].push_back(i);
+                edges_cells[5].push_back(i + (n_z-1)*n_x*n_y);
             }
+            break;
+        default:
+            break;
+    }
+    boundary_cells.clear();
+    for (size_t i_edge=0; i_edge<edges_cells.size(); i_edge++)
+    {
+        const auto bc = p.boundary_conditions.at(i_edge);
+        if (bc==BoundaryCondition::FLOATING) { continue; }
+        for (const auto i_cell : edges_cells[i_edge])
+        {
+            boundary_cells.push_back({i_cell, bc, p.bc_values.at(i_edge)});
         }
-    };
-    auto apply_boundary_conditions_1d = [&]()
+    }
+    std::stable_sort(
+        boundary_cells.begin(), boundary_cells.end(),
+        [&](const BoundaryCell& a, const BoundaryCell& b)
+            { return block_of(a.i_cell)<block_of(b.i_cell); }
+    );
+    // Corner cells are listed once per edge, all within the same block
+    std::vector<unsigned char> is_listed(n_cells, 0);
+    for (auto& cell : boundary_cells)
     {
-        // apply_bc_to_edge_1d(GridEdge::lx, p.boundary_conditions.at(0), p.bc_values.at(0));
-        // apply_bc_to_edge_1d(GridEdge::ux, p.boundary_conditions.at(1), p.bc_values.at(1));
-    };
-    auto apply_boundary_conditions_2d = [&]()
+        cell.is_relisted = is_listed[cell.i_cell];
+        is_listed[cell.i_cell] = 1;
+    }
+    boundary_densities.assign(boundary_cells.size(), 0.0);
+    block_boundary_offsets.assign(n_blocks()+1, 0);
+    for (const auto& cell : boundary_cells)
     {
-        apply_bc_to_edge_2d(
-            GridEdge::lx, p.boundary_conditions.at(0), p.bc_values.at(0)
-        );
-        apply_bc_to_edge_2d(
-            GridEdge::ux, p.boundary_conditions.at(1), p.bc_values.at(1)
-        );
-        apply_bc_to_edge_2d(
-            GridEdge::ly, p.boundary_conditions.at(2), p.bc_values.at(2)
-        );
-        apply_bc_to_edge_2d(
-            GridEdge::uy, p.boundary_conditions.at(3), p.bc_values.at(3)
-        );
-    };
-    auto apply_boundary_conditions_3d = [&]()
+        block_boundary_offsets[block_of(cell.i_cell)+1]++;
+    }
+    for (auto i_block=0; i_block<n_blocks(); i_block++)
     {
-        // apply_bc_to_edge(GridEdge::lx, p.boundary_conditions.at(0), p.bc_values.at(0));
-        // apply_bc_to_edge(GridEdge::ux, p.boundary_conditions.at(1), p.bc_values.at(1));
-        // apply_bc_to_edge(GridEdge::ly, p.boundary_conditions.at(2), p.bc_values.at(2));
-        // apply_bc_to_edge(GridEdge::uy, p.boundary_conditions.at(3), p.bc_values.at(3));
-    };
+        block_boundary_offsets[i_block+1] += block_boundary_offsets[i_block];
+    }
+}
 
-    switch (p.grid_dimension)
+//! Set each listed edge cell to its fixed value, or add its fixed flux
+//! over Δt (keeping the density nonnegative), noting if its block is now 
+//! occupied: the density beforehand is kept, in case the flux must be
+//! rescaled to a different Δt
+template<typename real_t>
+void Langevin<real_t>::apply_boundary_cells(
+    grid_t& grid, const int k_begin, const int k_end, 
+    const bool do_add_flux, double& density_sum
+)
+{
+    for (auto k=k_begin; k<k_end; k++)
     {
-        case (GridDimension::D1):
-            apply_boundary_conditions_1d();
-            break;
-        case (GridDimension::D2):
-            apply_boundary_conditions_2d();
-            break;
-        case (GridDimension::D3):
-            apply_boundary_conditions_3d();
-            break;
+        const auto& cell = boundary_cells[k];
+        const double density = grid[cell.i_cell];
+        boundary_densities[k] = density;
+        if (cell.boundary_condition==BoundaryCondition::FIXED_VALUE) 
+        {
+            grid[cell.i_cell] = cell.value;
+        }
+        else if (do_add_flux)
+        {
+            grid[cell.i_cell] = fmax(density + cell.value*dt, 0.0);
+        }
+        density_sum += grid[cell.i_cell] - density;
+        if (grid[cell.i_cell]!=0) 
+        { 
+            block_is_occupied[block_of(cell.i_cell)] = 1; 
+        }
+    }
+}
+
+//! Apply boundary conditions to every listed edge cell of the density grid
+//! in a pass of its own: needed only before the first step, and while 
+//! steps are skipped in the absorbing state
+template<typename real_t>
+void Langevin<real_t>::apply_boundary_conditions(const int i_epoch)
+{
+    double density_sum = 0;
+    // Don't "add flux" if we're at epoch#0
+    apply_boundary_cells(
+        density_grid, 0, static_cast<int>(boundary_cells.size()), 
+        i_epoch>0, density_sum
+    );
+}
+
+//! Fixed fluxes for the next epoch are added at the end of each step, 
+//! over that step's Δt: if the next step is of a different Δt, as in 
+//! adaptive runs, the conditions are applied afresh over it, from each 
+//! edge cell's density before they were applied. A corner cell takes the
+//! conditions of its edges in turn, as before, so a fixed value still 
+//! overrides any flux listed ahead of it.
+template<typename real_t>
+void Langevin<real_t>::rescale_boundary_fluxes(const double dt_step)
+{
+    if (dt_step==dt) { return; }
+    for (size_t k=0; k<boundary_cells.size(); k++)
+    {
+        const auto& cell = boundary_cells[k];
+        const double density = (cell.is_relisted) 
+            ? density_grid[cell.i_cell] : boundary_densities[k];
+        if (cell.boundary_condition==BoundaryCondition::FIXED_VALUE) 
+        {
+            density_grid[cell.i_cell] = cell.value;
+        }
+        else
+        {
+            density_grid[cell.i_cell] = fmax(density + cell.value*dt_step, 0.0);
+        }
+        if (density_grid[cell.i_cell]!=0) 
+        { 
+            block_is_occupied[block_of(cell.i_cell)] = 1; 
+        }
+    }
+}
+
+//! Apply the next epoch's boundary conditions to the edge cells, if any, 
+//! of the block starting at cell i_begin of `grid`, just updated by the
+//! final sweep of a step and so still in cache
+template<typename real_t>
+void Langevin<real_t>::apply_boundary_block(
+    grid_t& grid, const int i_begin, double& density_sum
+)
+{
+    const auto i_block = block_of(i_begin);
+    apply_boundary_cells(
+        grid, 
+        block_boundary_offsets[i_block], block_boundary_offsets[i_block+1], 
+        true, density_sum
+    );
+}
+
+//! Blocks skipped by a step still need the next epoch's boundary 
+//! conditions applied to their edge cells, and their state noting
+template<typename real_t>
+void Langevin<real_t>::apply_idle_boundary_conditions(
+    grid_t& grid, double& density_sum
+)
+{
+    for (auto i_block=0; i_block<n_blocks(); i_block++)
+    {
+        if (
+            block_is_active[i_block] 
+            or block_boundary_offsets[i_block]==block_boundary_offsets[i_block+1]
+        ) 
+        { 
+            continue; 
+        }
+        const auto i_begin = block_offsets[i_block];
+        apply_boundary_block(grid, i_begin, density_sum);
+        note_block_state(grid, i_begin, block_offsets[i_block+1]);
     }
 }
+
+template void Langevin<float>::apply_boundary_cells(
+    grid_t&, const int, const int, const bool, double&
+);
+template void Langevin<double>::apply_boundary_cells(
+    grid_t&, const int, const int, const bool, double&
+);
+template void Langevin<float>::apply_boundary_conditions(const int);
+template void Langevin<double>::apply_boundary_conditions(const int);
+template void Langevin<float>::rescale_boundary_fluxes(const double);
+template void Langevin<double>::rescale_boundary_fluxes(const double);
+template void Langevin<float>::apply_boundary_block(
+    grid_t&, const int, double&
+);
+template void Langevin<double>::apply_boundary_block(
+    grid_t&, const int, double&
+);
+template void Langevin<float>::apply_idle_boundary_conditions(
+    grid_t&, double&
+);
+template void Langevin<double>::apply_idle_boundary_conditions(
+    grid_t&, double&
+);
@@ -0,0 +1,354 @@
+/**
+ * @file langevin_blocks.cpp
+ * @brief Methods to split the grid into blocks, share them across threads,
+ * and skip blocks where nothing can happen.
+ */
+
+#include <algorithm>
+#include "langevin_types.hpp"
+#include "langevin_integrator.hpp"
+
+/**
+ * @details
+ * Split the grid into contiguous blocks of whole rows (of whole cells in 1D),
+ * each of roughly n_block_cells cells. The partition depends only on the
+ * grid size, not on the number of threads sharing the work.
+ *
+ * A 3d grid whose z-planes are smaller than a block is split into blocks
+ * of whole planes. Otherwise each z-plane is split into blocks of rows
+ * of its own, and blocks are swept in y-z tiles: all the blocks covering 
+ * one band of rows, plane after plane up the z axis, then the next band.
+ * So the 7-point stencil of a block finds its z-1 neighbors in the block 
+ * swept just before, still in cache, rather than a whole plane back.
+ */
+void BaseLangevin::partition_grid()
+{
+    const auto n_row_cells = (grid_dimension==GridDimension::D1) ? 1 : n_x;
+    const auto n_plane_cells = n_x*n_y;
+    auto n_block_rows = std::max(1, n_block_cells/n_row_cells);
+    n_cells_per_plane = n_cells;
+    if (grid_dimension==GridDimension::D3)
+    {
+        if (n_plane_cells<=n_block_cells)
+        {
+            n_block_rows = (n_block_cells/n_plane_cells)*n_y;
+        }
+        else
+        {
+            n_block_rows = std::min(n_block_rows, n_y);
+            n_cells_per_plane = n_plane_cells;
+        }
+    }
+    n_cells_per_block = n_block_rows*n_row_cells;
+    n_blocks_per_plane 
+        = (n_cells_per_plane + n_cells_per_block-1)/n_cells_per_block;
+    block_offsets.clear();
+    for (auto i_plane=0; i_plane<n_cells; i_plane+=n_cells_per_plane)
+    {
+        for (
+            auto i=i_plane; 
+            i<i_plane+n_cells_per_plane; 
+            i+=n_cells_per_block
+        )
+        {
+            block_offsets.push_back(i);
+        }
+    }
+    block_offsets.push_back(n_cells);
+    const auto n_planes = n_cells/n_cells_per_plane;
+    block_sweep_order.clear();
+    for (auto i_band=0; i_band<n_blocks_per_plane; i_band++)
+    {
+        for (auto i_plane=0; i_plane<n_planes; i_plane++)
+        {
+            block_sweep_order.push_back(i_plane*n_blocks_per_plane + i_band);
+        }
+    }
+    // To begin with, treat all blocks as occupied
+    block_is_occupied.assign(n_blocks(), 1);
+    block_is_active.assign(n_blocks(), 1);
+    block_n_idle_steps.assign(n_blocks(), 0);
+    active_blocks = block_sweep_order;
+}
+
+//! Link each block to every other block holding a neighbor of one of its
+//! cells, according to the grid wiring
+void BaseLangevin::wire_blocks()
+{
+    neighborhoods_t block_neighborhoods(n_blocks());
+    for (auto i_block=0; i_block<n_blocks(); i_block++)
+    {
+        auto& block_neighborhood = block_neighborhoods[i_block];
+        for (auto i=block_offsets[i_block]; i<block_offsets[i_block+1]; i++)
+        {
+            for (auto wire=grid_wiring->begin(i); wire<grid_wiring->end(i); wire++)
+            {
+                // Halo cells belong to other processes' blocks
+                if (*wire>=n_cells) { continue; }
+                const auto j_block = block_of(*wire);
+                if (j_block!=i_block) { block_neighborhood.push_back(j_block); }
+            }
+        }
+        std::sort(block_neighborhood.begin(), block_neighborhood.end());
+        block_neighborhood.erase(
+            std::unique(block_neighborhood.begin(), block_neighborhood.end()),
+            block_neighborhood.end()
+        );
+    }
+    block_wiring = grid_wiring_t(block_neighborhoods);
+}
+
+//! Number of blocks in the grid partition
+int BaseLangevin::n_blocks() const
+{
+    return static_cast<int>(block_offsets.size())-1;
+}
+
+//! Index of the block containing a given cell
+int BaseLangevin::block_of(const int i_cell) const
+{
+    return (i_cell/n_cells_per_plane)*n_blocks_per_plane 
+        + (i_cell%n_cells_per_plane)/n_cells_per_block;
+}
+
+//! Set the (externally owned) pool of threads to share block-wise sweeps
+void BaseLangevin::set_thread_pool(ThreadPool* thread_pool)
+{
+    this->thread_pool = thread_pool;
+}
+
+//! Whether block-wise sweeps are shared by more than one thread
+bool BaseLangevin::is_multithreaded() const
+{
+    return (thread_pool!=nullptr and thread_pool->get_n_threads()>1);
+}
+
+//! Apply `block_task(i_begin, i_end)` to every active block of the grid
+//! partition: blocks are shared across the thread pool if there is one,
+//! in which case the order in which they are processed is arbitrary
+void BaseLangevin::for_each_block(
+    const std::function<void(int, int)>& block_task
+)
+{
+    auto task = [&](const int i_active)
+    {
+        const auto i_block = active_blocks[i_active];
+        block_task(block_offsets[i_block], block_offsets[i_block+1]);
+    };
+    const auto n_active = static_cast<int>(active_blocks.size());
+    if (is_multithreaded())
+    {
+        thread_pool->parallel_for(n_active, task);
+    }
+    else
+    {
+        for (auto i_active=0; i_active<n_active; i_active++) { task(i_active); }
+    }
+}
+
+//! Apply `block_task(i_begin, i_end, block_sum)` to every active block of
+//! the grid partition, in parallel if a thread pool is set, and then total
+//! the blocks' sums in block order: so the total doesn't depend on the
+//! number of threads
+double BaseLangevin::sum_over_blocks(
+    const std::function<void(int, int, double&)>& block_task
+)
+{
+    block_sums.assign(n_blocks(), 0.0);
+    auto task = [&](const int i_active)
+    {
+        const auto i_block = active_blocks[i_active];
+        block_task(
+            block_offsets[i_block], block_offsets[i_block+1],
+            block_sums[i_block]
+        );
+    };
+    const auto n_active = static_cast<int>(active_blocks.size());
+    if (is_multithreaded())
+    {
+        thread_pool->parallel_for(n_active, task);
+    }
+    else
+    {
+        for (auto i_active=0; i_active<n_active; i_active++) { task(i_active); }
+    }
+    double sum = 0.0;
+    for (const auto& block_sum : block_sums) { sum += block_sum; }
+    return sum;
+}
+
+//! Whether every block of the grid is empty, i.e., the absorbing state
+//! has been reached: from here on, integration can't change anything
+bool BaseLangevin::is_absorbed() const
+{
+    return std::none_of(
+        block_is_occupied.begin(), block_is_occupied.end(),
+        [](const unsigned char is_occupied) { return is_occupied; }
+    );
+}
+
+/**
+ * @details
+ * Choose which blocks need integrating this step: a block that is empty,
+ * and whose cells are all more than `n_hops` neighbor links away from any
+ * occupied block, will stay empty however far an integration step
+ * lets density spread by diffusion (one link per Runge-Kutta stage).
+ * Since an empty cell draws no random numbers in the stochastic step,
+ * skipping such blocks leaves the results exactly unchanged.
+ *
+ * @param n_hops Number of neighbor links spanned by one integration step.
+ */
+void BaseLangevin::find_active_blocks(const int n_hops)
+{
+    // Spread activity out from occupied blocks, one block link per hop,
+    // until it spans n_hops links or stops spreading
+    block_is_active = block_is_occupied;
+    for (auto i_hop=0; i_hop<n_hops; i_hop++)
+    {
+        block_was_active = block_is_active;
+        auto did_spread = false;
+        for (auto i_block=0; i_block<n_blocks(); i_block++)
+        {
+            if (block_was_active[i_block]) { continue; }
+            for (
+                auto wire=block_wiring.begin(i_block);
+                wire<block_wiring.end(i_block);
+                wire++
+            )
+            {
+                if (block_was_active[*wire])
+                {
+                    block_is_active[i_block] = 1;
+                    did_spread = true;
+                    break;
+                }
+            }
+        }
+        if (not did_spread) { break; }
+    }
+    // List the active blocks in sweep order, and count how long the rest 
+    // have been idle
+    active_blocks.clear();
+    for (const auto i_block : block_sweep_order)
+    {
+        if (block_is_active[i_block])
+        {
+            active_blocks.push_back(i_block);
+            block_n_idle_steps[i_block] = 0;
+        }
+        else
+        {
+            block_n_idle_steps[i_block]++;
+        }
+    }
+}
+
+//! Flag every block that has any cell of nonzero density, 
+//! and gather the moments of every block if observing
+template<typename real_t>
+void Langevin<real_t>::find_occupied_blocks()
+{
+    for (auto i_block=0; i_block<n_blocks(); i_block++)
+    {
+        note_block_state(
+            density_grid, block_offsets[i_block], block_offsets[i_block+1]
+        );
+    }
+}
+
+//! Flag the block made up of cells i_begin...i_end-1 as occupied or not
+//! by whether any of its cells in `grid` has nonzero density.
+//! If observing, also sum the block's moments, while its cells are still
+//! in cache from the integration step.
+//! (Skipped blocks keep the zero moments of their last, empty, update.)
+template<typename real_t>
+void Langevin<real_t>::note_block_state(
+    const grid_t& grid, const int i_begin, const int i_end
+)
+{
+    const auto i_block = block_of(i_begin);
+    if (not do_observe)
+    {
+        block_is_occupied[i_block] = std::any_of(
+            grid.begin()+i_begin, grid.begin()+i_end,
+            [](const real_t density) { return density!=0; }
+        );
+        return;
+    }
+    BlockMoments moments;
+    for (auto i=i_begin; i<i_end; i++)
+    {
+        const double density = grid[i];
+        moments.n_active += (density!=0);
+        moments.density_sum += density;
+        moments.density_squared_sum += density*density;
+    }
+    if (not cell_radii_squared.empty())
+    {
+        for (auto i=i_begin; i<i_end; i++)
+        {
+            moments.radius_squared_sum += grid[i]*cell_radii_squared[i];
+        }
+    }
+    block_moments[i_block] = moments;
+    block_is_occupied[i_block] = (moments.n_active>0);
+}
+
+//! Flag the block holding cell i_cell as occupied if that cell has
+//! nonzero density
+template<typename real_t>
+void Langevin<real_t>::note_cell_occupancy(const int i_cell)
+{
+    if (density_grid[i_cell]!=0) { block_is_occupied[block_of(i_cell)] = 1; }
+}
+
+/**
+ * @details
+ * Choose which blocks need integrating this step, as above.
+ * Skipped blocks are not written to, so cells in the scratch grids
+ * `idle_grids` are zeroed in any block that has only just gone idle, in case
+ * they are read by a neighboring active block. Blocks are considered
+ * "just idle" for two steps, since the Euler method swaps its two grids.
+ *
+ * @param n_hops Number of neighbor links spanned by one integration step.
+ * @param idle_grids Pointers to scratch grids read across block boundaries.
+ */
+template<typename real_t>
+void Langevin<real_t>::find_active_blocks(
+    const int n_hops, const std::vector<grid_t*>& idle_grids
+)
+{
+    BaseLangevin::find_active_blocks(n_hops);
+    for (auto i_block=0; i_block<n_blocks(); i_block++)
+    {
+        if (block_is_active[i_block] or block_n_idle_steps[i_block]>2) 
+        { 
+            continue; 
+        }
+        for (auto& grid : idle_grids)
+        {
+            std::fill(
+                grid->begin()+block_offsets[i_block],
+                grid->begin()+block_offsets[i_block+1],
+                0
+            );
+        }
+    }
+}
+
+template void Langevin<float>::find_occupied_blocks();
+template void Langevin<double>::find_occupied_blocks();
+template void Langevin<float>::note_block_state(
+    const grid_t&, const int, const int
+);
+template void Langevin<double>::note_block_state(
+    const grid_t&, const int, const int
+);
+template void Langevin<float>::note_cell_occupancy(const int);
+template void Langevin<double>::note_cell_occupancy(const int);
+template void Langevin<float>::find_active_blocks(
+    const int, const std::vector<grid_t*>&
+);
+template void Langevin<double>::find_active_blocks(
+    const int, const std::vector<grid_t*>&
+);
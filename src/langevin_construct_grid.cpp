@@ -1,22 +1,86 @@
 /**
  * @file langevin_construct_grid.cpp
- * @brief Wrapper around 1D or 2D grid construction methods.
+ * @brief Langevin integrator constructors, and wrapper around 1D or 2D 
+ * grid construction methods.
  */
 
 #include "langevin_types.hpp"
-#include "langevin_base.hpp"
+#include "langevin_integrator.hpp"
 
-bool BaseLangevin::construct_grid(const Parameters p)
+//! Take "local" copies of the model parameters the integrator needs
+BaseLangevin::BaseLangevin(const Parameters& p) :
+    n_cells(p.n_cells),
+    grid_dimension(p.grid_dimension),
+    n_x(p.n_x), n_y(p.n_y), n_z(p.n_z),
+    dt(p.dt), dx(p.dx),
+    random_generator(p.random_generator),
+    random_seed(p.random_seed)
+{}
+
+//! Allocate the density field grid, and the supplementary grids used 
+//! by the integrators, as 1d vectors at the chosen precision
+template<typename real_t>
+Langevin<real_t>::Langevin(const Parameters& p) : BaseLangevin(p)
 {
-    switch (p.grid_dimension)
+    density_grid = grid_t(n_cells, 0); 
+    aux_grid1 = grid_t(n_cells, 0);
+    aux_grid2 = grid_t(n_cells, 0);
+    k1_grid = grid_t(n_cells, 0);
+    k2_grid = grid_t(n_cells, 0);
+    // The cache-blocked Runge-Kutta method sums k2 and k3 on the fly
+    if (p.integration_method!=IntegrationMethod::RUNGE_KUTTA_BLOCKED)
+    {
+        k3_grid = grid_t(n_cells, 0);
+    }
+}
+
+//! Construct the grid: wire its cells, or share the wiring of an identical
+//! grid still in use, then split it into blocks and link them
+bool BaseLangevin::construct_grid(const Parameters& p)
+{
+    auto wire_grid = [&]() -> bool
+    {
+        switch (p.grid_dimension)
+        {
+            case (GridDimension::D1):
+                return construct_1D_grid(p);
+            case (GridDimension::D2):
+                return construct_2D_grid(p);
+            case (GridDimension::D3):
+                return construct_3D_grid(p);
+            default:
+                return false;
+        }    
+    };
+    if (domain.is_decomposed())
     {
-        case (GridDimension::D1):
-            return construct_1D_grid(p);
-        case (GridDimension::D2):
-            return construct_2D_grid(p);
-        case (GridDimension::D3):
-            return false; // NYI
-        default:
-            return false;
-    }    
-}
\ No newline at end of file
+        if (not wire_grid()) { return false; }
+    }
+    else
+    {
+        auto& cache = GridWiringCache::instance();
+        const auto grid_key = GridWiringCache::key(
+            p.grid_dimension, p.n_x, p.n_y, p.n_z, p.grid_topologies
+        );
+        grid_wiring = cache.find(grid_key);
+        if (not grid_wiring)
+        {
+            if (not wire_grid()) { return false; }
+            grid_wiring = cache.insert(grid_key, grid_wiring);
+        }
+    }
+    // Split grid into blocks for integration sweeps, and link the blocks
+    partition_grid();
+    wire_blocks();
+    return true;
+}
+
+//! Holding on to the wiring keeps it in the cache of wirings in use,
+//! for identical grids constructed later
+std::shared_ptr<const grid_wiring_t> BaseLangevin::get_grid_wiring() const
+{
+    return grid_wiring;
+}
+
+template Langevin<float>::Langevin(const Parameters&);
+template Langevin<double>::Langevin(const Parameters&);
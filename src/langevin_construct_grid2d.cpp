@@ -3,6 +3,8 @@
  * @brief Method for setting up a 2D grid for the model Langevin field.
  */
 
+#include <algorithm>
+#include <cassert>
 #include "langevin_types.hpp"
 #include "langevin_base.hpp"
 
@@ -21,13 +23,17 @@
 * If only one edge is periodic, the grid topology is cylindrical.
 * If both are bounded, the grid topology is a bounded plane.
 *
+* If the grid is decomposed into slabs (see set_domain), the whole grid
+* is wired just the same, but only the links of this slab's cells are
+* kept, and those leading to rows beyond the slab lead to its halo cells.
+*
 * @param BaseLangevin integrator Parameters bundle.
 */
-bool BaseLangevin::construct_2D_grid(const Parameters p)
+bool BaseLangevin::construct_2D_grid(const Parameters& p)
 {
-    // Shorthand
+    // Shorthand: wire the whole grid, even if this is just one slab of it
     const auto n_x = p.n_x;
-    const auto n_y = p.n_y;
+    const auto n_y = domain.is_decomposed() ? domain.n_y_global : p.n_y;
 
     // Flattened grid vector each with a vector of connection elements.
     // Each connection element will link to between 2 and 4 neighbor locations.
@@ -35,13 +41,18 @@ bool BaseLangevin::construct_2D_grid(const Parameters p)
     // Along periodic edges there will be 3 connection elements.
     // Along bounded edges there will be 2 connection elements.
     // At corners these sets will be reduced to 2-3 elements.
-    grid_wiring = grid_wiring_t(n_x*n_y, neighborhood_t(0));
+    neighborhoods_t neighborhoods(n_cells, neighborhood_t(0));
 
     // Compute flattened grid vector index from coordinate
     auto i_from_xy = [&](int x, int y) -> int { return x + y*n_x; };
     
-    // Connect two neighbor cells
-    auto connect_cells = [&](int i, int j){ grid_wiring.at(i).push_back(j); };
+    // Connect two neighbor cells, if the first is in this slab
+    auto connect_cells = [&](int i, int j)
+    { 
+        const auto i_local = local_cell(i);
+        if (i_local<0 or i_local>=n_cells) { return; }
+        neighborhoods.at(i_local).push_back(local_cell(j)); 
+    };
 
     // Central grid cells
     auto wire_central_cell = [&](int x, int y)
@@ -57,7 +68,10 @@ bool BaseLangevin::construct_2D_grid(const Parameters p)
     };
     auto wire_central_cells = [&]()
     {
-        for (auto y=1; y<n_y-1; y++)
+        const auto y_begin = std::max(1, domain.y_begin);
+        const auto y_end = domain.is_decomposed()
+            ? std::min(n_y-1, domain.y_end) : n_y-1;
+        for (auto y=y_begin; y<y_end; y++)
         {
             for (auto x=1; x<n_x-1; x++)
             {
@@ -245,6 +259,9 @@ bool BaseLangevin::construct_2D_grid(const Parameters p)
     // Step 2: Wire grid edge cells according to topology specs
     wire_edge_cells(p.grid_topologies);
 
+    // Step 3: Pack the neighborhoods into compact form for the integrators
+    grid_wiring = std::make_shared<const grid_wiring_t>(neighborhoods);
+
     /////////////////////////////////////////////
 
     return true;
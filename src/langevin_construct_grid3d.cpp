@@ -0,0 +1,81 @@
+/**
+ * @file langevin_construct_grid3d.cpp
+ * @brief Method for setting up a 3D grid for the model Langevin field.
+ */
+
+#include "langevin_types.hpp"
+#include "langevin_base.hpp"
+
+/**
+* @details
+* Construct a connected 3D grid to be used for solving the evolution
+* of a density field ρ(x,t), with cells indexed as x + y*n_x + z*n_x*n_y.
+*
+* As in 2D, the grid edge topology along each axis can separately be
+* specified as "bounded" or "periodic", and the first two topologies
+* keep their 2D meaning: periodic "x edges" (the first and last rows of
+* each z-plane) wrap the grid along y, and periodic "y edges" (the first
+* and last columns) wrap it along x. The third topology, of the "z edges"
+* (the first and last planes), wraps the grid along z.
+*
+* Each cell is linked to its (up to) six neighbors in the order
+* z+1, z-1, y+1, y-1, x+1, x-1, which is the order in which the
+* vectorized 7-point stencil sums them.
+* Since 3D grids run to many millions of cells, the wiring is built directly
+* in compact form, without the per-cell neighborhood lists used in 1D and 2D.
+*
+* @param BaseLangevin integrator Parameters bundle.
+*/
+bool BaseLangevin::construct_3D_grid(const Parameters& p)
+{
+    if (p.grid_topologies.size()<3) { return false; }
+    // Shorthand
+    const auto n_x = p.n_x;
+    const auto n_y = p.n_y;
+    const auto n_z = p.n_z;
+    const auto n_xy = n_x*n_y;
+    const auto is_periodic_y
+        = (p.grid_topologies[0]==GridTopology::PERIODIC);
+    const auto is_periodic_x
+        = (p.grid_topologies[1]==GridTopology::PERIODIC);
+    const auto is_periodic_z
+        = (p.grid_topologies[2]==GridTopology::PERIODIC);
+
+    auto wiring = std::make_shared<grid_wiring_t>();
+    auto& offsets = wiring->offsets;
+    auto& neighbors = wiring->neighbors;
+    offsets.reserve(static_cast<size_t>(n_cells)+1);
+    neighbors.reserve(static_cast<size_t>(n_cells)*6);
+    offsets.push_back(0);
+
+    // Link cell i, at coordinate c along an axis of n cells spaced
+    // `stride` apart in the flattened grid, to its two neighbors along
+    // that axis, wrapping around the grid if it's periodic that way
+    auto connect_along_axis = [&](
+        const int i, const int c, const int n, const int stride,
+        const bool is_periodic
+    )
+    {
+        if (c<n-1) { neighbors.push_back(i+stride); }
+        else if (is_periodic) { neighbors.push_back(i-(n-1)*stride); }
+        if (c>0) { neighbors.push_back(i-stride); }
+        else if (is_periodic) { neighbors.push_back(i+(n-1)*stride); }
+    };
+
+    for (auto z=0; z<n_z; z++)
+    {
+        for (auto y=0; y<n_y; y++)
+        {
+            for (auto x=0; x<n_x; x++)
+            {
+                const auto i_cell = x + y*n_x + z*n_xy;
+                connect_along_axis(i_cell, z, n_z, n_xy, is_periodic_z);
+                connect_along_axis(i_cell, y, n_y, n_x, is_periodic_y);
+                connect_along_axis(i_cell, x, n_x, 1, is_periodic_x);
+                offsets.push_back(static_cast<int>(neighbors.size()));
+            }
+        }
+    }
+    grid_wiring = wiring;
+    return true;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file langevin_domain.cpp
+ * @brief Methods for integrating one slab of a 2D grid decomposed across
+ * processes.
+ */
+
+#include <algorithm>
+#include "langevin_types.hpp"
+#include "langevin_integrator.hpp"
+
+/**
+ * @details Make this integrator responsible for just one slab of rows
+ * of a 2D grid, the rest being integrated by other processes which
+ * exchange halo rows with this one through `halo_exchanger`.
+ * Must be called before `construct_grid`, with the model parameters
+ * giving the size of the slab itself, n_x × domain.n_rows(): the
+ * slab is then wired as part of the whole grid, with links across
+ * the slab's edges leading to halo cells, and the grids are extended
+ * by two halo rows.
+ * Only the Euler and stage-by-stage Runge-Kutta integrators support
+ * decomposed grids: the cache-blocked method has no point at which all
+ * the slab's cells have completed a stage, for halos to be exchanged.
+ */
+template<typename real_t>
+bool Langevin<real_t>::set_domain(
+    const GridDomain& domain, HaloExchanger* halo_exchanger
+)
+{
+    if (
+        grid_dimension!=GridDimension::D2
+        or domain.n_rows()!=n_y
+        or domain.n_rows()<2
+        or (domain.is_decomposed() and halo_exchanger==nullptr)
+    )
+    {
+        return false;
+    }
+    this->domain = domain;
+    this->halo_exchanger = domain.is_decomposed() ? halo_exchanger : nullptr;
+    i_first_cell = domain.y_begin*n_x;
+    const auto n_grid_cells = n_cells + (domain.is_decomposed() ? 2*n_x : 0);
+    for (
+        auto grid : {
+            &density_grid, &aux_grid1, &aux_grid2, &k1_grid, &k2_grid, &k3_grid
+        }
+    )
+    {
+        if (not grid->empty()) { grid->resize(n_grid_cells, 0); }
+    }
+    return true;
+}
+
+//! Index in this slab's grids of the cell with index i_global in the whole
+//! grid: its own index if the slab holds it, the index of its halo cell
+//! if it lies in the row just below or above the slab (wrapping around
+//! the grid's y edges), and otherwise -1
+int BaseLangevin::local_cell(const int i_global) const
+{
+    if (not domain.is_decomposed()) { return i_global; }
+    const auto x = i_global % n_x;
+    const auto y = i_global / n_x;
+    if (y>=domain.y_begin and y<domain.y_end)
+    {
+        return i_global - i_first_cell;
+    }
+    if (y==(domain.y_begin-1+domain.n_y_global) % domain.n_y_global)
+    {
+        return n_cells + x;
+    }
+    if (y==domain.y_end % domain.n_y_global)
+    {
+        return n_cells + n_x + x;
+    }
+    return -1;
+}
+
+//! Sum the density over all slabs, in a call made by every process
+void BaseLangevin::reduce_mean_density()
+{
+    if (not halo_exchanger) { return; }
+    mean_density = (
+        halo_exchanger->sum(mean_density*n_cells)
+            / (static_cast<double>(n_x)*domain.n_y_global)
+    );
+}
+
+//! Fill the halo rows following the slab's cells in `grid` with the
+//! neighboring slabs' edge rows, in a call made by every process
+template<typename real_t>
+void Langevin<real_t>::exchange_halos(grid_t& grid)
+{
+    if (halo_exchanger) { halo_exchanger->exchange(grid.data(), n_x, n_cells); }
+}
+
+//! At the start of a step, fill the density grid's halo rows, and flag
+//! the slab's first or last block as occupied if the row beyond it holds
+//! any density: so activity spreads across slabs as it does across blocks
+template<typename real_t>
+void Langevin<real_t>::exchange_density_halos()
+{
+    if (not halo_exchanger) { return; }
+    exchange_halos(density_grid);
+    auto is_occupied = [&](const int i_begin)
+    {
+        return std::any_of(
+            density_grid.begin()+i_begin, density_grid.begin()+i_begin+n_x,
+            [](const real_t density) { return density!=0; }
+        );
+    };
+    if (is_occupied(n_cells)) { block_is_occupied[block_of(0)] = 1; }
+    if (is_occupied(n_cells+n_x))
+    {
+        block_is_occupied[block_of(n_cells-1)] = 1;
+    }
+}
+
+template bool Langevin<float>::set_domain(const GridDomain&, HaloExchanger*);
+template bool Langevin<double>::set_domain(const GridDomain&, HaloExchanger*);
+template void Langevin<float>::exchange_halos(grid_t&);
+template void Langevin<double>::exchange_halos(grid_t&);
+template void Langevin<float>::exchange_density_halos();
+template void Langevin<double>::exchange_density_halos();
@@ -0,0 +1,74 @@
+/**
+ * @file langevin_domain.hpp
+ * @brief Decomposition of a 2D grid into slabs of rows, each integrated
+ * by a separate process.
+ */
+
+#ifndef DOMAIN_HPP
+#define DOMAIN_HPP
+
+/**
+ * @brief Slab of whole rows of a 2D grid owned by one of several processes.
+ *
+ * A 2D grid of n_x × n_y_global cells can be split along y into slabs,
+ * one per process: each integrates its own rows, reading the rows just
+ * beyond its slab from one-row "halos" refreshed by its neighbors before
+ * every sweep that reads them. Slabs are as even as possible, and each
+ * must have at least two rows.
+ */
+struct GridDomain
+{
+    //! Index of this slab, counting up the y axis
+    int i_domain = 0;
+    //! Number of slabs the grid is split into
+    int n_domains = 1;
+    //! Number of rows of the whole grid
+    int n_y_global = 0;
+    //! First row of the whole grid owned by this slab
+    int y_begin = 0;
+    //! One past the last row owned by this slab
+    int y_end = 0;
+
+    GridDomain() = default;
+    //! Slab #i_domain of n_domains, of a grid of n_y_global rows
+    GridDomain(const int n_y_global, const int i_domain, const int n_domains) :
+        i_domain(i_domain), n_domains(n_domains), n_y_global(n_y_global),
+        y_begin(
+            static_cast<int>(static_cast<long long>(n_y_global)*i_domain/n_domains)
+        ),
+        y_end(
+            static_cast<int>(static_cast<long long>(n_y_global)*(i_domain+1)/n_domains)
+        )
+    {}
+
+    //! Number of rows owned by this slab
+    int n_rows() const { return y_end-y_begin; }
+    //! Whether the grid is split across more than one process
+    bool is_decomposed() const { return n_domains>1; }
+};
+
+/**
+ * @brief Exchange of halo rows and global sums between the processes
+ * integrating the slabs of a decomposed grid.
+ *
+ * The integrator knows nothing of how processes communicate: it just
+ * calls `exchange` with a grid of its slab's n_cells cells followed by
+ * its two halo rows, of n_x cells each, the first for the row below the
+ * slab and the second for the row above it. The exchanger must send the
+ * slab's first and last rows to its neighbors below and above, and fill
+ * the halo rows with theirs. Every process makes the same sequence of
+ * calls, so they can be collective.
+ */
+class HaloExchanger
+{
+public:
+    virtual ~HaloExchanger() = default;
+    //! Fill the halo rows following the n_cells cells of `grid`
+    virtual void exchange(float* grid, const int n_x, const int n_cells) = 0;
+    //! Fill the halo rows following the n_cells cells of `grid`
+    virtual void exchange(double* grid, const int n_x, const int n_cells) = 0;
+    //! Total of `value` over all processes
+    virtual double sum(const double value) = 0;
+};
+
+#endif
@@ -10,7 +10,7 @@
 #ifndef ENUMS_HPP
 #define ENUMS_HPP
 
-//! Density field grid dimension: only 1D or 2D grids implemented so far
+//! Density field grid dimension: 1D, 2D or 3D grids
 enum class GridDimension
 {
     D1 = 1,
@@ -24,9 +24,9 @@ enum class GridEdge
     lx = 1,
     ux = 2,
     ly = 3,
-    uy = 4
-    // lz = 5,
-    // uz = 6
+    uy = 4,
+    lz = 5,
+    uz = 6
 };
 
 //! Grid boundary topology: only bounded or periodic (along all edges) implemented so far
@@ -53,11 +53,37 @@ enum class InitialCondition
     SINGLE_SEED = 4
 };
 
-//! Deterministic integration method: default is 4th-order Runge-Kutta; can be explicit Euler
+//! Deterministic integration method: default is 4th-order Runge-Kutta; can be explicit Euler, Runge-Kutta cache-blocked (single-threaded) for grids too big for cache, or Runge-Kutta for the nonlinear terms split from implicit diffusion, for large DΔt/Δx²
 enum class IntegrationMethod
 {
     EULER = 1,
-    RUNGE_KUTTA = 2
+    RUNGE_KUTTA = 2,
+    RUNGE_KUTTA_BLOCKED = 3,
+    IMPLICIT_DIFFUSION = 4
+};
+
+//! Random number generation for the stochastic step: one Mersenne Twister stream for the whole grid (serial), or counter-based Philox streams per cell and step (parallel, reproducible)
+enum class RandomGenerator
+{
+    MERSENNE_TWISTER = 1,
+    PHILOX = 2
+};
+
+//! Grid-wide observables measurable at every epoch alongside the mean density: fraction of active (nonzero) cells; mean squared density; spatial variance of density; density-weighted mean squared distance from the seed cell; and survival (1 while any cell is active, else 0)
+enum class Observable
+{
+    ACTIVE_FRACTION = 1,
+    MEAN_SQUARED_DENSITY = 2,
+    DENSITY_VARIANCE = 3,
+    SPREAD_RADIUS_SQUARED = 4,
+    SURVIVAL = 5
+};
+
+//! Floating-point precision of the density field grids: double by default, or float to halve memory use (grid averages are still accumulated in double)
+enum class Precision
+{
+    FLOAT64 = 1,
+    FLOAT32 = 2
 };
 
 #endif
\ No newline at end of file
@@ -3,10 +3,12 @@
  * @brief Methods for setting up the initial condition of the Langevin model.
  */
 
+#include <algorithm>
 #include "langevin_types.hpp"
-#include "langevin_base.hpp"
+#include "langevin_integrator.hpp"
 
-bool BaseLangevin::initialize_grid(const Parameters p, rng_t& rng)
+template<typename real_t>
+bool Langevin<real_t>::initialize_grid(const Parameters& p, rng_t& rng)
 {
     // Set grid cells to have uniformly random values 
     // between min_value and max_value
@@ -17,8 +19,11 @@ bool BaseLangevin::initialize_grid(const Parameters p, rng_t& rng)
     )
     {
         uniform_dist_t uniform_sampler(min_value, max_value);
+        // A slab of a decomposed grid skips the values of the slabs 
+        // before it, so its cells start out as they would in the whole grid
+        for (auto i=0; i<i_first_cell; i++) { uniform_sampler(rng); }
         mean_density = 0.0;
-        for (auto i=0; i<density_grid.size(); i++)
+        for (auto i=0; i<n_cells; i++)
         {
             density_grid[i] = uniform_sampler(rng);
             mean_density += density_grid[i];
@@ -35,8 +40,9 @@ bool BaseLangevin::initialize_grid(const Parameters p, rng_t& rng)
     )
     {
         gaussian_dist_t gaussian_sampler(mean, stddev);
+        for (auto i=0; i<i_first_cell; i++) { gaussian_sampler(rng); }
         mean_density = 0.0;
-        for (auto i=0; i<density_grid.size(); i++)
+        for (auto i=0; i<n_cells; i++)
         {
             density_grid[i] = gaussian_sampler(rng);
             mean_density += density_grid[i];
@@ -47,23 +53,31 @@ bool BaseLangevin::initialize_grid(const Parameters p, rng_t& rng)
     // Set all the grid cells to have same value
     auto ic_constant_value = [&](const double density_value)
     {
-        density_grid = grid_t(n_cells, density_value);
+        std::fill(
+            density_grid.begin(), density_grid.begin()+n_cells,
+            static_cast<real_t>(density_value)
+        );
         mean_density = density_value;
     };
 
-    // Set all the grid cells to zero except a single specified cell
+    // Set all the grid cells to zero except a single specified cell,
+    // which may lie in another slab of a decomposed grid
     auto ic_single_seed = [&](const int i_cell, const double value)
     {
+        mean_density = 0.0;
+        if (i_cell<0 or i_cell>=n_cells) { return; }
         density_grid[i_cell] = value;
         mean_density = value / static_cast<double>(n_cells);
     }; 
 
+    bool did_initialize;
     switch (p.initial_condition)
     {
         int i_cell;
         case (InitialCondition::CONSTANT_VALUE):
             ic_constant_value(p.ic_values.at(0));
-            return true;
+            did_initialize = true;
+            break;
         case (InitialCondition::SINGLE_SEED):
             if (p.grid_dimension==GridDimension::D1)
             {
@@ -74,25 +88,44 @@ bool BaseLangevin::initialize_grid(const Parameters p, rng_t& rng)
             {
                 i_cell = (static_cast<int>(p.ic_values.at(1))
                         + static_cast<int>(p.ic_values.at(2))*p.n_x);
-                if (i_cell<0 or i_cell>=p.n_x*p.n_y) { return false; }
+                const auto n_y_whole 
+                    = domain.is_decomposed() ? domain.n_y_global : p.n_y;
+                if (i_cell<0 or i_cell>=p.n_x*n_y_whole) { return false; }
+                i_cell = local_cell(i_cell);
             } 
             else if (p.grid_dimension==GridDimension::D3)
             {
-                return false;
+                i_cell = (static_cast<int>(p.ic_values.at(1))
+                        + static_cast<int>(p.ic_values.at(2))*p.n_x
+                        + static_cast<int>(p.ic_values.at(3))*p.n_x*p.n_y);
+                if (i_cell<0 or i_cell>=p.n_cells) { return false; }
             } 
             else 
             { 
                 return false; 
             }
             ic_single_seed(i_cell, p.ic_values.at(0));
-            return true;
+            did_initialize = true;
+            break;
         case (InitialCondition::RANDOM_UNIFORM):
             ic_random_uniform(rng, p.ic_values.at(0), p.ic_values.at(1));
-            return true;
+            did_initialize = true;
+            break;
         case (InitialCondition::RANDOM_GAUSSIAN):
             ic_random_gaussian(rng, p.ic_values.at(0), p.ic_values.at(1));
-            return true;
+            did_initialize = true;
+            break;
         default:
-            return false;
+            did_initialize = false;
     }  
+    // Note which blocks of the grid have any density to integrate
+    if (did_initialize) 
+    { 
+        find_occupied_blocks(); 
+        reduce_mean_density();
+    }
+    return did_initialize;
 }
+
+template bool Langevin<float>::initialize_grid(const Parameters&, rng_t&);
+template bool Langevin<double>::initialize_grid(const Parameters&, rng_t&);
@@ -4,22 +4,77 @@
  */ 
 
 #include "langevin_types.hpp"
-#include "langevin_base.hpp"
+#include "langevin_integrator.hpp"
 
-//! Perform explicit-Euler then stochastic integration steps, then update grid
-void BaseLangevin::integrate_euler(rng_t& rng)
+//! Perform explicit-Euler then stochastic integration steps, then update grid.
+//! If multithreaded with the single shared rng, the deterministic step is 
+//! shared across threads block by block, and the stochastic step follows 
+//! in a serial sweep; with per-cell Philox rng streams, both steps are 
+//! shared across threads.
+//! Blocks more than one neighbor link from any occupied block are empty 
+//! and stay so, and are skipped.
+//! The next epoch's boundary conditions are applied to each block's edge
+//! cells at the end of its stochastic step.
+//! If the grid is decomposed into slabs, the density's halo rows are 
+//! refreshed before the step starts.
+template<typename real_t>
+void Langevin<real_t>::integrate_euler(rng_t& rng)
 {
-    mean_density = 0.0;
-    for (auto i=0; i<n_cells; i++)
+    // Time step at grid precision
+    const real_t dtf = dt;
+    auto step_deterministic = [&](const int i_begin, const int i_end)
     {
-        double f = nonlinear_rhs(i, density_grid);
-        aux_grid1[i] = density_grid[i] + f*dt;
-        poisson_sampler = poisson_dist_t(lambda_on_explcdt * aux_grid1[i]);
-        gamma_sampler = gamma_dist_t(poisson_sampler(rng), 1/lambda);
-        aux_grid1[i]= gamma_sampler(rng);
-        mean_density += aux_grid1[i];
-    }    
+        nonlinear_rhs_block(density_grid, i_begin, i_end, aux_grid1);
+        for (auto i=i_begin; i<i_end; i++)
+        {
+            aux_grid1[i] = density_grid[i] + aux_grid1[i]*dtf;
+        }
+    };
+
+    exchange_density_halos();
+    find_active_blocks(1, {&aux_grid1});
+    if (random_generator==RandomGenerator::PHILOX)
+    {
+        mean_density = sum_over_blocks(
+            [&](const int i_begin, const int i_end, double& density_sum)
+        {
+            step_deterministic(i_begin, i_end);
+            stochastic_block(aux_grid1, i_begin, i_end, density_sum);
+            apply_boundary_block(aux_grid1, i_begin, density_sum);
+            note_block_state(aux_grid1, i_begin, i_end);
+        });
+    }
+    else if (is_multithreaded())
+    {
+        mean_density = 0.0;
+        for_each_block(step_deterministic);
+        for (const auto i_block : active_blocks)
+        {
+            const auto i_begin = block_offsets[i_block];
+            const auto i_end = block_offsets[i_block+1];
+            stochastic_block(aux_grid1, i_begin, i_end, rng, mean_density);
+            apply_boundary_block(aux_grid1, i_begin, mean_density);
+            note_block_state(aux_grid1, i_begin, i_end);
+        }
+    }
+    else
+    {
+        mean_density = 0.0;
+        for_each_block([&](const int i_begin, const int i_end)
+        {
+            step_deterministic(i_begin, i_end);
+            stochastic_block(aux_grid1, i_begin, i_end, rng, mean_density);
+            apply_boundary_block(aux_grid1, i_begin, mean_density);
+            note_block_state(aux_grid1, i_begin, i_end);
+        });
+    }
+    apply_idle_boundary_conditions(aux_grid1, mean_density);
     mean_density /= static_cast<double>(n_cells);   
+    reduce_mean_density();
     // Update density field grid with result of integration
     density_grid.swap(aux_grid1); 
-}
\ No newline at end of file
+    i_step++;
+}
+
+template void Langevin<float>::integrate_euler(rng_t&);
+template void Langevin<double>::integrate_euler(rng_t&);
@@ -0,0 +1,191 @@
+/**
+ * @file langevin_integrate_implicit.cpp
+ * @brief Methods to carry out integration with implicit diffusion,
+ * split from the explicit nonlinear (reaction) terms.
+ */
+
+#include <algorithm>
+#include "langevin_types.hpp"
+#include "langevin_integrator.hpp"
+
+//! Factorize the system for implicit diffusion along lines of n cells,
+//! with coupling r = DΔt/Δx²: lines of two cells that wrap around link
+//! them twice over, so they make a plain (not cyclic) system with
+//! double coupling
+void DiffusionLineSolver::factorize(
+    const int n, const double r, const bool is_periodic
+)
+{
+    this->n = n;
+    is_cyclic = (is_periodic and n>2);
+    coupling = (is_periodic and n==2) ? 2*r : r;
+    inv_pivots.assign(n, 0);
+    uppers.assign(n, 0);
+    corrections.clear();
+    if (n<2) { return; }
+    // Diagonal: 1 + r per link
+    dbl_vec_t diagonal(n, 1+2*r);
+    if (not is_cyclic) { diagonal[0] = diagonal[n-1] = 1+coupling; }
+    // Sherman-Morrison: drop the corner links -r from the cyclic system,
+    // compensating along the diagonal with a parameter γ=-(1+2r)
+    const auto gamma = -diagonal[0];
+    if (is_cyclic)
+    {
+        diagonal[0] -= gamma;
+        diagonal[n-1] -= r*r/gamma;
+    }
+    inv_pivots[0] = 1/diagonal[0];
+    for (auto i=1; i<n; i++)
+    {
+        inv_pivots[i] = 1/(diagonal[i] - coupling*coupling*inv_pivots[i-1]);
+    }
+    for (auto i=0; i<n-1; i++) { uppers[i] = coupling*inv_pivots[i]; }
+    if (not is_cyclic) { return; }
+    // Correction vector: solution of the tridiagonal system for the
+    // corner links' column (γ, 0, ..., 0, -r)
+    corrections.assign(n, 0);
+    corrections[0] = gamma;
+    corrections[n-1] = -r;
+    is_cyclic = false;
+    solve(corrections.data(), 1, 1);
+    is_cyclic = true;
+    last_weight = -r/gamma;
+    denominator = 1 + corrections[0] + last_weight*corrections[n-1];
+}
+
+/**
+ * @details Factorize the implicit diffusion systems along each grid axis
+ * for the current Δt. Whether an axis wraps around is read from the grid
+ * wiring: it does if its first cell is linked to the last cell along
+ * the axis (twice over, if the axis is only two cells long).
+ */
+void BaseLangevin::factorize_diffusion()
+{
+    const int n_axis_cells[3] = {n_x, n_y, n_z};
+    const int strides[3] = {1, n_x, n_x*n_y};
+    const auto r = get_diffusion_rate()*dt;
+    diffusion_solvers.resize(3);
+    for (auto i_axis=0; i_axis<3; i_axis++)
+    {
+        const auto n = n_axis_cells[i_axis];
+        const auto i_far = (n-1)*strides[i_axis];
+        const auto n_links = std::count(
+            grid_wiring->begin(0), grid_wiring->end(0), i_far
+        );
+        const auto is_periodic = (n>1 and n_links==((n==2) ? 2 : 1));
+        diffusion_solvers[i_axis].factorize(n, r, is_periodic);
+    }
+    diffusion_dt = dt;
+}
+
+/**
+ * @details Integration step split into three parts:
+ *   - the nonlinear "reaction" terms of the RHS, local to each cell,
+ *     are integrated explicitly, by 4th-order Runge-Kutta;
+ *   - diffusion is then integrated implicitly, by backward Euler along
+ *     each axis in turn (a locally one-dimensional splitting), solving
+ *     a tridiagonal system along each line of cells, or a cyclic one if
+ *     the axis is periodic: this is stable for any Δt, however large DΔt/Δx²;
+ *   - the Dornic stochastic step follows as for the other methods, with
+ *     the next epoch's boundary conditions applied to each block's edge
+ *     cells at its end.
+ *
+ * Implicit diffusion spreads density along whole lines in one step, so
+ * no blocks can be skipped (short of an empty grid). Lines are shared
+ * across threads, rows one by one, and lines along y and z in strips.
+ * Decomposed grids are not supported, since lines cross slabs.
+ */
+template<typename real_t>
+void Langevin<real_t>::integrate_implicit(rng_t& rng)
+{
+    const real_t dt_half = dt/2, dt_full = dt, dt_sixth = dt/6;
+    auto step_reaction = [&](const int i_begin, const int i_end)
+    {
+        auto substep = [&](const grid_t& k_grid, const real_t dtf)
+        {
+            for (auto i=i_begin; i<i_end; i++)
+            {
+                aux_grid2[i] = density_grid[i] + k_grid[i]*dtf;
+            }
+        };
+        reaction_rhs_block(density_grid, i_begin, i_end, k1_grid);
+        substep(k1_grid, dt_half);
+        reaction_rhs_block(aux_grid2, i_begin, i_end, k2_grid);
+        substep(k2_grid, dt_half);
+        reaction_rhs_block(aux_grid2, i_begin, i_end, k3_grid);
+        substep(k3_grid, dt_full);
+        reaction_rhs_block(aux_grid2, i_begin, i_end, aux_grid1);
+        for (auto i=i_begin; i<i_end; i++)
+        {
+            aux_grid1[i] = density_grid[i] + (
+                k1_grid[i] + 2*(k2_grid[i]+k3_grid[i]) + aux_grid1[i]
+            )*dt_sixth;
+        }
+    };
+    auto parallel_for = [&](
+        const int n_tasks, const std::function<void(int)>& task
+    )
+    {
+        if (is_multithreaded()) { thread_pool->parallel_for(n_tasks, task); }
+        else { for (auto i_task=0; i_task<n_tasks; i_task++) { task(i_task); } }
+    };
+    // Solve along one axis: each of n_groups groups of n_group_lines
+    // adjacent lines, n_group_cells apart, is split into strips
+    auto solve_axis = [&](
+        const DiffusionLineSolver& solver, const int stride,
+        const int n_groups, const int n_group_lines, const int n_group_cells
+    )
+    {
+        if (solver.n<2) { return; }
+        const auto n_strip_lines = DiffusionLineSolver::n_strip_lines;
+        const auto n_strips = (n_group_lines + n_strip_lines-1)/n_strip_lines;
+        parallel_for(n_groups*n_strips, [&](const int i_task)
+        {
+            const auto i_group = i_task/n_strips;
+            const auto i_line = (i_task%n_strips)*n_strip_lines;
+            solver.solve(
+                aux_grid1.data()
+                    + static_cast<size_t>(i_group)*n_group_cells + i_line,
+                stride, std::min(n_strip_lines, n_group_lines-i_line)
+            );
+        });
+    };
+
+    if (diffusion_dt!=dt) { factorize_diffusion(); }
+    find_active_blocks(n_blocks(), {&aux_grid1});
+    for_each_block(step_reaction);
+    const auto n_xy = n_x*n_y;
+    solve_axis(diffusion_solvers[0], 1, n_y*n_z, 1, n_x);
+    solve_axis(diffusion_solvers[1], n_x, n_z, n_x, n_xy);
+    solve_axis(diffusion_solvers[2], n_xy, 1, n_xy, 0);
+    if (random_generator==RandomGenerator::PHILOX)
+    {
+        mean_density = sum_over_blocks(
+            [&](const int i_begin, const int i_end, double& density_sum)
+        {
+            stochastic_block(aux_grid1, i_begin, i_end, density_sum);
+            apply_boundary_block(aux_grid1, i_begin, density_sum);
+            note_block_state(aux_grid1, i_begin, i_end);
+        });
+    }
+    else
+    {
+        mean_density = 0.0;
+        for (const auto i_block : active_blocks)
+        {
+            const auto i_begin = block_offsets[i_block];
+            const auto i_end = block_offsets[i_block+1];
+            stochastic_block(aux_grid1, i_begin, i_end, rng, mean_density);
+            apply_boundary_block(aux_grid1, i_begin, mean_density);
+            note_block_state(aux_grid1, i_begin, i_end);
+        }
+    }
+    apply_idle_boundary_conditions(aux_grid1, mean_density);
+    mean_density /= static_cast<double>(n_cells);
+    // Update density field grid with result of integration
+    density_grid.swap(aux_grid1);
+    i_step++;
+}
+
+template void Langevin<float>::integrate_implicit(rng_t&);
+template void Langevin<double>::integrate_implicit(rng_t&);
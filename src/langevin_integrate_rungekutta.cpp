@@ -3,55 +3,160 @@
  * @brief Methods to carry out 4th-order Runge-Kutta integration.
  */
 
+#include <algorithm>
+#include <cmath>
 #include "langevin_types.hpp"
-#include "langevin_base.hpp"
+#include "langevin_integrator.hpp"
 
 //! Runge-Kutta integration of the nonlinear and diffusion terms 
 //! in the Langevin equation.
+//! Each stage evaluates the RHS one block of grid rows at a time, and then 
+//! updates those same (still cached) cells; blocks are shared across 
+//! threads if a thread pool has been set.
 //! Update of cells is done in the same loop as last Runge-Kutta step 
-//! for efficiency.
-void BaseLangevin::integrate_rungekutta(rng_t& rng)
+//! for efficiency, unless multithreaded with the single shared rng, 
+//! in which case the stochastic step is done in a serial sweep.
+//! With per-cell Philox rng streams, the stochastic step is fused with 
+//! the last Runge-Kutta step and shared across threads.
+//! Blocks more than four neighbor links from any occupied block 
+//! (one link per stage) are empty and stay so, and are skipped.
+//! The next epoch's boundary conditions are applied to each block's edge
+//! cells at the end of its stochastic step.
+//! If the grid is decomposed into slabs, the halo rows of the field each
+//! stage reads are refreshed before it starts.
+//! If error estimation is on, the 4th step also records each block's
+//! largest scaled local error estimate, for adapting Δt.
+template<typename real_t>
+void Langevin<real_t>::integrate_rungekutta(rng_t& rng)
 {
-    auto step1 = [&](grid_t& aux_grid, grid_t& k1_grid, const double dtf)
+    auto step1 = [&](grid_t& aux_grid, grid_t& k1_grid, const real_t dtf)
     {
-        for (auto i=0; i<n_cells; i++)
+        for_each_block([&](const int i_begin, const int i_end)
         {
-            k1_grid[i] = nonlinear_rhs(i, density_grid);
-            aux_grid[i] = density_grid[i] + k1_grid[i]*dtf;
-        }
+            nonlinear_rhs_block(density_grid, i_begin, i_end, k1_grid);
+            for (auto i=i_begin; i<i_end; i++)
+            {
+                aux_grid[i] = density_grid[i] + k1_grid[i]*dtf;
+            }
+        });
     };
     auto step2or3 = [&](
         const grid_t& aux_grid_in, grid_t& aux_grid_out, grid_t& k23_grid, 
-        const double dtf)
+        const real_t dtf)
     {
-        for (auto i=0; i<n_cells; i++)
+        for_each_block([&](const int i_begin, const int i_end)
+        {
+            nonlinear_rhs_block(aux_grid_in, i_begin, i_end, k23_grid);
+            for (auto i=i_begin; i<i_end; i++)
+            {
+                aux_grid_out[i] = density_grid[i] + k23_grid[i]*dtf;
+            }
+        });
+    };
+    auto step4_deterministic = [&](
+        const grid_t& aux_grid, const grid_t& k1_grid, const grid_t& k2_grid, 
+        const grid_t& k3_grid, grid_t& k4_grid, const real_t dtf,
+        const int i_begin, const int i_end)
+    {
+        // Runge-Kutta 4th step
+        nonlinear_rhs_block(aux_grid, i_begin, i_end, k4_grid);
+        if (do_estimate_error)
+        {
+            // Difference between this update and an Euler update, k1Δt,
+            // relative to 1+ρ: an estimate of local error of first order
+            double error = 0;
+            for (auto i=i_begin; i<i_end; i++)
+            {
+                const double difference = (
+                    2*(k2_grid[i]+k3_grid[i]) + k4_grid[i] - 5*k1_grid[i]
+                )*dtf;
+                error = std::max(
+                    error, std::abs(difference)/(1+std::abs(density_grid[i]))
+                );
+            }
+            block_errors[block_of(i_begin)] = error;
+        }
+        for (auto i=i_begin; i<i_end; i++)
         {
-            k23_grid[i] = nonlinear_rhs(i, aux_grid_in);
-            aux_grid_out[i] = density_grid[i] + k23_grid[i]*dtf;
+            density_grid[i] += (
+                k1_grid[i] + 2*(k2_grid[i]+k3_grid[i]) + k4_grid[i]
+            )*dtf;
         }
     };
     auto step4 = [&](
         const grid_t& aux_grid, const grid_t& k1_grid, const grid_t& k2_grid, 
-        const grid_t& k3_grid, rng_t& rng, const double dtf)
+        const grid_t& k3_grid, grid_t& k4_grid, rng_t& rng, const real_t dtf)
     {
-        mean_density = 0.0;
-        for (auto i=0; i<n_cells; i++)
+        if (random_generator==RandomGenerator::PHILOX)
         {
-            // Runge-Kutta 4th step
-            auto k4 = nonlinear_rhs(i, aux_grid);
-            density_grid[i] += (k1_grid[i] + 2*(k2_grid[i]+k3_grid[i]) +k4)*dtf;
-            // Stochastic step
-            poisson_sampler = poisson_dist_t(lambda_on_explcdt*density_grid[i]);
-            gamma_sampler = gamma_dist_t(poisson_sampler(rng), 1/lambda);
-            density_grid[i] = gamma_sampler(rng);
-            // Incrementally compute mean density
-            mean_density += density_grid[i];
-        }    
+            // Per-cell rng streams: fuse both steps and share across threads
+            mean_density = sum_over_blocks(
+                [&](const int i_begin, const int i_end, double& density_sum)
+            {
+                step4_deterministic(
+                    aux_grid, k1_grid, k2_grid, k3_grid, k4_grid, dtf, 
+                    i_begin, i_end
+                );
+                stochastic_block(density_grid, i_begin, i_end, density_sum);
+                apply_boundary_block(density_grid, i_begin, density_sum);
+                note_block_state(density_grid, i_begin, i_end);
+            });
+        }
+        else if (is_multithreaded())
+        {
+            // Shared rng: only the deterministic step can be parallelized
+            mean_density = 0.0;
+            for_each_block([&](const int i_begin, const int i_end)
+            {
+                step4_deterministic(
+                    aux_grid, k1_grid, k2_grid, k3_grid, k4_grid, dtf, 
+                    i_begin, i_end
+                );
+            });
+            for (const auto i_block : active_blocks)
+            {
+                const auto i_begin = block_offsets[i_block];
+                const auto i_end = block_offsets[i_block+1];
+                stochastic_block(
+                    density_grid, i_begin, i_end, rng, mean_density
+                );
+                apply_boundary_block(density_grid, i_begin, mean_density);
+                note_block_state(density_grid, i_begin, i_end);
+            }
+        }
+        else
+        {
+            mean_density = 0.0;
+            for_each_block([&](const int i_begin, const int i_end)
+            {
+                step4_deterministic(
+                    aux_grid, k1_grid, k2_grid, k3_grid, k4_grid, dtf, 
+                    i_begin, i_end
+                );
+                stochastic_block(
+                    density_grid, i_begin, i_end, rng, mean_density
+                );
+                apply_boundary_block(density_grid, i_begin, mean_density);
+                note_block_state(density_grid, i_begin, i_end);
+            });
+        }
+        apply_idle_boundary_conditions(density_grid, mean_density);
         mean_density /= static_cast<double>(n_cells);    
+        reduce_mean_density();
     };
 
+    exchange_density_halos();
+    find_active_blocks(4, {&aux_grid1, &aux_grid2});
     step1(aux_grid1, k1_grid, dt/2);
+    exchange_halos(aux_grid1);
     step2or3(aux_grid1, aux_grid2, k2_grid, dt/2);
+    exchange_halos(aux_grid2);
     step2or3(aux_grid2, aux_grid1, k3_grid, dt);
-    step4(aux_grid1, k1_grid, k2_grid, k3_grid, rng, dt/6);
-}
\ No newline at end of file
+    exchange_halos(aux_grid1);
+    // Grid aux_grid2 is free again, so use it to hold k4
+    step4(aux_grid1, k1_grid, k2_grid, k3_grid, aux_grid2, rng, dt/6);
+    i_step++;
+}
+
+template void Langevin<float>::integrate_rungekutta(rng_t&);
+template void Langevin<double>::integrate_rungekutta(rng_t&);
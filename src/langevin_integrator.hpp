@@ -0,0 +1,140 @@
+/**
+ * @file langevin_integrator.hpp
+ * @brief Langevin equation integrator at a chosen floating-point precision.
+ */
+
+#ifndef INTEGRATOR_HPP
+#define INTEGRATOR_HPP
+
+#include "langevin_base.hpp"
+#include "langevin_philox.hpp"
+#include "langevin_samplers.hpp"
+
+/**
+ * @brief Langevin equation integrator at a chosen floating-point precision.
+ *
+ * The density field and the scratch grids of the integrators are stored
+ * as `real_t`, either double or float: in single precision, grids take
+ * half the memory, and the deterministic RHS sweeps fit twice as many
+ * cells per SIMD register. The stochastic step is computed in double
+ * precision cell by cell, and grid averages are always accumulated
+ * in double precision.
+ *
+ * Method definitions are spread over the `langevin_*.cpp` files, each of
+ * which instantiates its methods for both float and double.
+ */
+template<typename real_t>
+class Langevin : public BaseLangevin
+{
+public:
+    //! Type for density grid, at the chosen precision
+    typedef std::vector<real_t> grid_t;
+
+protected:
+    //! Density field grid
+    grid_t density_grid;
+    //! Runge-Kutta variable grid #1
+    grid_t k1_grid;
+    //! Runge-Kutta variable grid #2
+    grid_t k2_grid;
+    //! Runge-Kutta variable grid #3
+    grid_t k3_grid;
+    //! Temporary density grid used to perform an integration step
+    grid_t aux_grid1;
+    //! Temporary density grid used to perform an integration step
+    grid_t aux_grid2;
+
+    //! Apply boundary conditions to edge cells #k_begin...#k_end-1 of `grid`, adding fluxes if `do_add_flux`, and add the change in density to `density_sum`
+    void apply_boundary_cells(
+        grid_t& grid, const int k_begin, const int k_end, 
+        const bool do_add_flux, double& density_sum
+    );
+    //! Apply the next epoch's boundary conditions to the edge cells of the block starting at cell i_begin of `grid`
+    void apply_boundary_block(
+        grid_t& grid, const int i_begin, double& density_sum
+    );
+    //! Apply the next epoch's boundary conditions to the edge cells of blocks skipped this step
+    void apply_idle_boundary_conditions(grid_t& grid, double& density_sum);
+    //! Fill the halo rows of `grid` from the neighboring slabs, if the grid is decomposed
+    void exchange_halos(grid_t& grid);
+    //! Fill the density grid's halo rows, and flag the blocks next to any occupied ones
+    void exchange_density_halos();
+    //! Flag one block as occupied or not, and gather its moments if observing, given its updated cells in `grid`
+    void note_block_state(
+        const grid_t& grid, const int i_begin, const int i_end
+    );
+    //! Flag the block holding a cell as occupied if the cell's density is nonzero
+    void note_cell_occupancy(const int i_cell);
+    //! Choose the blocks to integrate, and clear scratch grids in newly idle blocks
+    void find_active_blocks(
+        const int n_hops, const std::vector<grid_t*>& idle_grids
+    );
+    //! Dornic stochastic step for one cell, given its deterministically updated density
+    template<typename urbg_t>
+    double stochastic_step(const double density, urbg_t& urbg) const;
+    //! Dornic stochastic step for cells i_begin...i_end-1, drawing from the shared rng
+    void stochastic_block(
+        grid_t& grid, const int i_begin, const int i_end,
+        rng_t& rng, double& density_sum
+    ) const;
+    //! Dornic stochastic step for cells i_begin...i_end-1, drawing from per-cell Philox streams
+    void stochastic_block(
+        grid_t& grid, const int i_begin, const int i_end, double& density_sum
+    ) const;
+
+public:
+    //! Default constructor
+    Langevin() = default;
+    //! Constructor allocating grids to the size given in the model parameters
+    Langevin(const Parameters& p);
+
+    bool set_domain(
+        const GridDomain& domain, HaloExchanger* halo_exchanger
+    ) override;
+    bool initialize_grid(const Parameters& parameters, rng_t& rng) override;
+    void apply_boundary_conditions(const int i_epoch) override;
+    void rescale_boundary_fluxes(const double dt_step) override;
+    void integrate_rungekutta(rng_t& rng) override;
+    void integrate_rungekutta_blocked(rng_t& rng) override;
+    void integrate_euler(rng_t& rng) override;
+    void integrate_implicit(rng_t& rng) override;
+    double get_density_grid_value(const int) const override;
+    void find_occupied_blocks() override;
+    void copy_density_grid(const int stride, double* frame) const override;
+    bool write_density_grid(std::FILE* file) const override;
+    bool read_density_grid(std::FILE* file) override;
+    //! Fetch the density field grid itself: its buffer is stable except across Euler steps, which swap grids
+    const grid_t& get_density_grid() const { return density_grid; }
+
+    //! Method to set nonlinear RHS of Langevin equation for deterministic integration step: to be defined by application
+    virtual real_t nonlinear_rhs(const int i_cell, const grid_t& field) const
+        { return 0; };
+    //! Method to evaluate nonlinear RHS over a contiguous block of cells: defaults to per-cell `nonlinear_rhs` calls
+    virtual void nonlinear_rhs_block(
+        const grid_t& field, const int i_begin, const int i_end, grid_t& rhs
+    ) const;
+    //! Method to evaluate the RHS less its diffusion term (which must leave only terms local to each cell) over a contiguous block of cells: defaults to the whole RHS, for models with no separate diffusion rate
+    virtual void reaction_rhs_block(
+        const grid_t& field, const int i_begin, const int i_end, grid_t& rhs
+    ) const;
+};
+
+/**
+ * @details Dornic stochastic step for one cell: the density after the
+ * deterministic step sets the mean of a Poisson variate, which in turn sets
+ * the shape of the gamma variate that becomes the cell's new density.
+ * The random bits can come from any C++ uniform random bit generator,
+ * such as the shared rng_t or a per-cell PhiloxStream.
+ * Cells with zero density draw no random numbers at all.
+ */
+template<typename real_t>
+template<typename urbg_t>
+inline double Langevin<real_t>::stochastic_step(
+    const double density, urbg_t& urbg
+) const
+{
+    const auto n_poisson = sample_poisson(lambda_on_explcdt*density, urbg);
+    return sample_gamma(n_poisson, 1/lambda, urbg);
+}
+
+#endif
@@ -0,0 +1,118 @@
+/**
+ * @file langevin_observables.cpp
+ * @brief Methods to measure grid-wide observables of the Langevin field.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "langevin_types.hpp"
+#include "langevin_base.hpp"
+
+//! Distance along one axis between cells at x and x0 of a line of n cells,
+//! taking the nearest periodic image if the axis wraps around
+static double axis_distance(
+    const int x, const double x0, const int n, const GridTopology topology
+)
+{
+    const auto distance = std::fabs(x-x0);
+    if (topology==GridTopology::PERIODIC)
+    {
+        return std::min(distance, n-distance);
+    }
+    return distance;
+}
+
+/**
+ * @details Choose which observables are to be measured as the grid is 
+ * integrated: their per-block moments are then gathered as each block's 
+ * cells are updated, rather than in another sweep over the grid. 
+ * If the spread R² is wanted, the squared distance of each cell from
+ * the seed cell (for a SINGLE_SEED initial condition) or else from the 
+ * grid center, is tabulated here, in units of Δx and using the nearest 
+ * image along periodic axes.
+ * The moments are only valid once every block has been visited, e.g.,
+ * by `find_occupied_blocks`.
+ */
+void BaseLangevin::set_observables(
+    const Parameters& parameters, const obs_vec_t& observables
+)
+{
+    do_observe = not observables.empty();
+    block_moments.assign(do_observe ? n_blocks() : 0, BlockMoments());
+    cell_radii_squared.clear();
+    if (
+        std::find(
+            observables.begin(), observables.end(), 
+            Observable::SPREAD_RADIUS_SQUARED
+        )==observables.end()
+    )
+    {
+        return;
+    }
+    const auto is_seeded 
+        = (parameters.initial_condition==InitialCondition::SINGLE_SEED);
+    const double x0 = is_seeded ? parameters.ic_values.at(1) : n_x/2;
+    const auto is_1d = (grid_dimension==GridDimension::D1);
+    const auto is_3d = (grid_dimension==GridDimension::D3);
+    const double y0 = (is_seeded and not is_1d) 
+        ? parameters.ic_values.at(2) : n_y/2;
+    const double z0 = (is_seeded and is_3d) 
+        ? parameters.ic_values.at(3) : n_z/2;
+    // In 2d and 3d, periodic "x edges" (rows) wrap the grid along y, and
+    // periodic "y edges" (columns) wrap it along x
+    const auto x_topology = parameters.grid_topologies.at(is_1d ? 0 : 1);
+    const auto y_topology = is_1d 
+        ? GridTopology::BOUNDED : parameters.grid_topologies.at(0);
+    const auto z_topology = is_3d 
+        ? parameters.grid_topologies.at(2) : GridTopology::BOUNDED;
+    const auto n_xy = n_x*n_y;
+    cell_radii_squared.resize(n_cells);
+    for (auto i=0; i<n_cells; i++)
+    {
+        const auto rx = axis_distance(i%n_x, x0, n_x, x_topology);
+        const auto ry = axis_distance((i%n_xy)/n_x, y0, n_y, y_topology);
+        const auto rz = is_3d 
+            ? axis_distance(i/n_xy, z0, n_z, z_topology) : 0.0;
+        cell_radii_squared[i] = (rx*rx + ry*ry + rz*rz)*dx*dx;
+    }
+}
+
+/**
+ * @details Total the per-block moments, in block order so that the result
+ * doesn't depend on the number of threads, and compute an observable:
+ *   - ACTIVE_FRACTION: fraction of cells with nonzero density;
+ *   - MEAN_SQUARED_DENSITY: grid average of ρ²;
+ *   - DENSITY_VARIANCE: grid average of ρ² minus the squared mean density;
+ *   - SPREAD_RADIUS_SQUARED: density-weighted mean of r², 
+ *     i.e., R² = Σρr²/Σρ (zero if the grid is empty);
+ *   - SURVIVAL: 1 if any cell has nonzero density, else 0.
+ */
+double BaseLangevin::get_observable(const Observable observable) const
+{
+    BlockMoments total;
+    for (const auto& moments : block_moments)
+    {
+        total.n_active += moments.n_active;
+        total.density_sum += moments.density_sum;
+        total.density_squared_sum += moments.density_squared_sum;
+        total.radius_squared_sum += moments.radius_squared_sum;
+    }
+    const auto mean = total.density_sum/n_cells;
+    const auto mean_squared = total.density_squared_sum/n_cells;
+    switch (observable)
+    {
+        case (Observable::ACTIVE_FRACTION):
+            return total.n_active/n_cells;
+        case (Observable::MEAN_SQUARED_DENSITY):
+            return mean_squared;
+        case (Observable::DENSITY_VARIANCE):
+            return std::max(mean_squared - mean*mean, 0.0);
+        case (Observable::SPREAD_RADIUS_SQUARED):
+            return (total.density_sum>0) 
+                ? total.radius_squared_sum/total.density_sum : 0;
+        case (Observable::SURVIVAL):
+            return (total.n_active>0) ? 1 : 0;
+        default:
+            return 0;
+    }
+}
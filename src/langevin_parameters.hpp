@@ -36,6 +36,8 @@ public:
     const InitialCondition initial_condition=InitialCondition::RANDOM_UNIFORM;
     const dbl_vec_t ic_values={};
     const IntegrationMethod integration_method=IntegrationMethod::RUNGE_KUTTA;
+    const RandomGenerator random_generator=RandomGenerator::MERSENNE_TWISTER;
+    const Precision precision=Precision::FLOAT64;
 
     Parameters() = default;
     Parameters(
@@ -49,7 +51,9 @@ public:
         const dbl_vec_t bcv,
         const InitialCondition ic,
         const dbl_vec_t icv,
-        const IntegrationMethod im
+        const IntegrationMethod im,
+        const RandomGenerator rg,
+        const Precision pr
     ) : 
         t_final(t_final), 
         dx(dx), dt(dt), 
@@ -61,7 +65,9 @@ public:
         bc_values(bcv),
         initial_condition(ic), 
         ic_values(icv),
-        integration_method(im)
+        integration_method(im),
+        random_generator(rg),
+        precision(pr)
     {
         n_x = gs.at(0);
         n_y = (gs.size()>1) ? gs.at(1) : 1;
@@ -128,9 +134,9 @@ public:
         if (gd==GridDimension::D3)
         {
             combo.append("; z0 edge:");
-            combo.append(report(bcs.at(2)));
+            combo.append(report(bcs.at(4)));
             combo.append(", z1 edge:");
-            combo.append(report(bcs.at(2)));
+            combo.append(report(bcs.at(5)));
         }
         return combo;
     }
@@ -149,6 +155,26 @@ public:
         switch (im) {
             case IntegrationMethod::EULER: return "Euler";
             case IntegrationMethod::RUNGE_KUTTA: return "Runge-Kutta";
+            case IntegrationMethod::RUNGE_KUTTA_BLOCKED: 
+                return "Runge-Kutta (cache-blocked)";
+            case IntegrationMethod::IMPLICIT_DIFFUSION: 
+                return "Runge-Kutta with implicit diffusion";
+            default: return "Unknown";
+        }
+    }
+    std::string report(RandomGenerator rg) 
+    {
+        switch (rg) {
+            case RandomGenerator::MERSENNE_TWISTER: return "Mersenne Twister";
+            case RandomGenerator::PHILOX: return "Philox (per cell)";
+            default: return "Unknown";
+        }
+    }
+    std::string report(Precision pr) 
+    {
+        switch (pr) {
+            case Precision::FLOAT64: return "float64 (double)";
+            case Precision::FLOAT32: return "float32 (single)";
             default: return "Unknown";
         }
     }
@@ -180,6 +206,10 @@ public:
             std::cout << std::endl;        
         std::cout << "integration_method: "  
             << report(integration_method) << std::endl;
+        std::cout << "random_generator: "  
+            << report(random_generator) << std::endl;
+        std::cout << "precision: "  
+            << report(precision) << std::endl;
     }
 };
 
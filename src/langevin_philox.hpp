@@ -0,0 +1,99 @@
+/**
+ * @file langevin_philox.hpp
+ * @brief Counter-based Philox4x32-10 random number streams.
+ */
+
+#ifndef PHILOX_HPP
+#define PHILOX_HPP
+
+#include <cstdint>
+
+/**
+ * @brief Counter-based random number stream using the Philox4x32-10 cipher.
+ *
+ * Philox (Salmon et al, 2011, "Parallel random numbers: as easy as 1, 2, 3")
+ * turns a 128-bit counter and a 64-bit key into 128 random bits, with no
+ * state carried from one draw to the next. Here the key is the simulation 
+ * random seed, and the counter is made of the integration step index, the
+ * grid cell index, and a running index of draws for that cell. 
+ * So each cell at each step gets its own independent stream, whose 
+ * values don't depend on the order in which cells are visited (or on which
+ * thread visits them), and which can be recreated at will.
+ *
+ * The stream satisfies the C++ UniformRandomBitGenerator requirements, 
+ * so it can be passed to the `std::` distributions in place of `rng_t`.
+ */
+class PhiloxStream
+{
+public:
+    typedef std::uint32_t result_type;
+
+    //! Constructor: stream for a given seed, integration step and cell
+    PhiloxStream(
+        const std::uint64_t seed, 
+        const std::uint64_t i_step, 
+        const std::uint32_t i_cell
+    ) : key{
+            static_cast<std::uint32_t>(seed), 
+            static_cast<std::uint32_t>(seed >> 32)
+        },
+        counter{
+            i_cell,
+            static_cast<std::uint32_t>(i_step), 
+            static_cast<std::uint32_t>(i_step >> 32),
+            0
+        },
+        i_word(4)
+    {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFF; }
+
+    //! Next 32 random bits of the stream
+    result_type operator()()
+    {
+        if (i_word==4)
+        {
+            generate_block();
+            counter[3]++;
+            i_word = 0;
+        }
+        return block[i_word++];
+    }
+
+    //! Philox4x32-10 bijection of `counter` under `key` (exposed for checking)
+    static void cipher(
+        const std::uint32_t key[2], 
+        const std::uint32_t counter[4], 
+        std::uint32_t output[4]
+    )
+    {
+        std::uint32_t k0=key[0], k1=key[1];
+        std::uint32_t c0=counter[0], c1=counter[1], c2=counter[2], c3=counter[3];
+        for (auto i_round=0; i_round<10; i_round++)
+        {
+            if (i_round>0) { k0 += 0x9E3779B9; k1 += 0xBB67AE85; }
+            const std::uint64_t p0 = std::uint64_t(0xD2511F53)*c0;
+            const std::uint64_t p1 = std::uint64_t(0xCD9E8D57)*c2;
+            c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            c1 = static_cast<std::uint32_t>(p1);
+            c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c3 = static_cast<std::uint32_t>(p0);
+        }
+        output[0]=c0; output[1]=c1; output[2]=c2; output[3]=c3;
+    }
+
+private:
+    //! Cipher key: the random seed
+    const std::uint32_t key[2];
+    //! Cipher counter: cell index, step index (2 words), block index
+    std::uint32_t counter[4];
+    //! Current block of 4 random words
+    std::uint32_t block[4];
+    //! Index of the next unused word in the current block
+    int i_word;
+
+    void generate_block() { cipher(key, counter, block); }
+};
+
+#endif
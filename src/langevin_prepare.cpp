@@ -13,13 +13,34 @@ void BaseLangevin::prepare(const Coefficients& coefficients)
     // Set "linear" coefficients
     linear_coefficient = coefficients.linear;
     noise_coefficient = coefficients.noise;
-    const auto explcdt = exp(-linear_coefficient*dt);
-    lambda = (
-        (2*linear_coefficient*explcdt)
-            / 
-        ((1-explcdt)*(noise_coefficient*noise_coefficient))
-    );
-    lambda_on_explcdt = lambda / explcdt;
+    // The "lambda" coefficients depend on them and on Δt
+    lambda_cache.clear();
+    set_dt(dt);
     // Set "nonlinear" coefficients in function supplied by child class
     set_nonlinear_coefficients(coefficients);
-}
\ No newline at end of file
+    // Any implicit diffusion solvers must be factorized afresh
+    diffusion_dt = 0;
+}
+
+//! Set the time step Δt, and the Dornic "lambda" coefficients for it: 
+//! these are computed the first time each distinct Δt is used, and cached,
+//! so that adaptive stepping among a few distinct Δt costs no recomputation
+void BaseLangevin::set_dt(const double dt)
+{
+    this->dt = dt;
+    auto cached = lambda_cache.find(dt);
+    if (cached==lambda_cache.end())
+    {
+        const auto explcdt = exp(-linear_coefficient*dt);
+        const auto lambda = (
+            (2*linear_coefficient*explcdt)
+                / 
+            ((1-explcdt)*(noise_coefficient*noise_coefficient))
+        );
+        cached = lambda_cache.insert(
+            std::make_pair(dt, std::make_pair(lambda, lambda / explcdt))
+        ).first;
+    }
+    lambda = cached->second.first;
+    lambda_on_explcdt = cached->second.second;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file langevin_rhs.cpp
+ * @brief Fallback block-wise evaluations of the nonlinear Langevin RHS.
+ */
+
+#include "langevin_types.hpp"
+#include "langevin_integrator.hpp"
+
+//! Evaluate the nonlinear RHS over cells i_begin...i_end-1 
+//! one virtual call at a time: models should override this for speed
+template<typename real_t>
+void Langevin<real_t>::nonlinear_rhs_block(
+    const grid_t& field, const int i_begin, const int i_end, grid_t& rhs
+) const
+{
+    for (auto i=i_begin; i<i_end; i++)
+    {
+        rhs[i] = nonlinear_rhs(i, field);
+    }
+}
+
+//! Evaluate the RHS less its diffusion term over cells i_begin...i_end-1:
+//! models that don't give a separate diffusion rate have no such term,
+//! and this is the whole RHS
+template<typename real_t>
+void Langevin<real_t>::reaction_rhs_block(
+    const grid_t& field, const int i_begin, const int i_end, grid_t& rhs
+) const
+{
+    nonlinear_rhs_block(field, i_begin, i_end, rhs);
+}
+
+template void Langevin<float>::nonlinear_rhs_block(
+    const grid_t&, const int, const int, grid_t&
+) const;
+template void Langevin<double>::nonlinear_rhs_block(
+    const grid_t&, const int, const int, grid_t&
+) const;
+template void Langevin<float>::reaction_rhs_block(
+    const grid_t&, const int, const int, grid_t&
+) const;
+template void Langevin<double>::reaction_rhs_block(
+    const grid_t&, const int, const int, grid_t&
+) const;
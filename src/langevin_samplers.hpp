@@ -0,0 +1,155 @@
+/**
+ * @file langevin_samplers.hpp
+ * @brief Poisson and gamma samplers tuned for the Dornic stochastic step.
+ *
+ * Every cell at every time step needs one Poisson variate, whose mean
+ * differs from cell to cell, followed by one gamma variate whose shape is
+ * that (integer) Poisson variate. The `std::` distributions are a poor fit:
+ * they are built afresh for each cell, recomputing setup tables every time,
+ * and they don't exploit the integer gamma shape.
+ * The samplers here need no setup state, and
+ *   - return zero without drawing any random numbers when the Poisson mean
+ *     is zero, which is the case for most cells in or near the absorbing
+ *     phase (and then the gamma variate is zero too);
+ *   - sample small-mean Poisson variates by inversion, and large-mean
+ *     variates by Hörmann's (1993) transformed rejection method "PTRS";
+ *   - sample gamma variates of small integer shape as sums of exponential
+ *     variates, and otherwise by the method of Marsaglia & Tsang (2000).
+ *
+ * All of them take any C++ uniform random bit generator of 32-bit words,
+ * such as rng_t or PhiloxStream.
+ */
+
+#ifndef SAMPLERS_HPP
+#define SAMPLERS_HPP
+
+#include <cmath>
+#include <cstdint>
+
+//! Uniform variate on the open interval (0,1) with 53 random bits
+template<typename urbg_t>
+inline double sample_uniform(urbg_t& urbg)
+{
+    static_assert(
+        urbg_t::min()==0 and urbg_t::max()==0xFFFFFFFF,
+        "sample_uniform needs a generator of 32-bit words"
+    );
+    const std::uint32_t a = urbg() >> 5;
+    const std::uint32_t b = urbg() >> 6;
+    return (a*67108864.0 + b + 0.5) * (1.0/9007199254740992.0);
+}
+
+//! Standard normal variate by the Box-Muller transform
+template<typename urbg_t>
+inline double sample_gaussian(urbg_t& urbg)
+{
+    const auto u = sample_uniform(urbg);
+    const auto v = sample_uniform(urbg);
+    return std::sqrt(-2*std::log(u)) * std::cos(6.283185307179586*v);
+}
+
+//! Logarithm of the gamma function ln Γ(x) for x≥1, without touching the
+//! global `signgam` that makes `std::lgamma` unsafe to share across threads
+inline double log_gamma(double x)
+{
+    static const double stirling_coefficients[10] = {
+        8.333333333333333e-02, -2.777777777777778e-03,
+        7.936507936507937e-04, -5.952380952380952e-04,
+        8.417508417508418e-04, -1.917526917526918e-03,
+        6.410256410256410e-03, -2.955065359477124e-02,
+        1.796443723688307e-01, -1.392432216905900e+00
+    };
+    if (x==1.0 or x==2.0) { return 0.0; }
+    // Shift small x up to where the Stirling series converges well
+    const int n_shift = (x<7.0) ? static_cast<int>(7.0-x) : 0;
+    auto x0 = x + n_shift;
+    const auto x2 = 1/(x0*x0);
+    auto series = stirling_coefficients[9];
+    for (auto k=8; k>=0; k--) { series = series*x2 + stirling_coefficients[k]; }
+    auto result = (
+        series/x0 + 0.9189385332046727 + (x0-0.5)*std::log(x0) - x0
+    );
+    // ...and shift back down using Γ(x+1) = xΓ(x)
+    for (auto k=0; k<n_shift; k++)
+    {
+        x0 -= 1;
+        result -= std::log(x0);
+    }
+    return result;
+}
+
+//! Poisson variate of given mean: zero (with no draws) if mean≤0;
+//! inversion for small means; PTRS transformed rejection for large means
+template<typename urbg_t>
+inline int sample_poisson(const double mean, urbg_t& urbg)
+{
+    if (not (mean>0)) { return 0; }
+    if (mean<10)
+    {
+        // Sequential search of the cumulative distribution
+        const auto u = sample_uniform(urbg);
+        auto k = 0;
+        auto p = std::exp(-mean);
+        auto cdf = p;
+        while (u>cdf and k<1000)
+        {
+            k++;
+            p *= mean/k;
+            cdf += p;
+        }
+        return k;
+    }
+    // Hörmann (1993) PTRS method
+    const auto sqrt_mean = std::sqrt(mean);
+    const auto log_mean = std::log(mean);
+    const auto b = 0.931 + 2.53*sqrt_mean;
+    const auto a = -0.059 + 0.02483*b;
+    const auto log_inv_alpha = std::log(1.1239 + 1.1328/(b-3.4));
+    const auto v_r = 0.9277 - 3.6224/(b-2);
+    while (true)
+    {
+        const auto u = sample_uniform(urbg) - 0.5;
+        const auto v = sample_uniform(urbg);
+        const auto u_s = 0.5 - std::fabs(u);
+        const auto k = std::floor((2*a/u_s + b)*u + mean + 0.43);
+        if (u_s>=0.07 and v<=v_r) { return static_cast<int>(k); }
+        if (k<0 or (u_s<0.013 and v>u_s)) { continue; }
+        if (
+            std::log(v) + log_inv_alpha - std::log(a/(u_s*u_s) + b)
+                <= -mean + k*log_mean - log_gamma(k+1)
+        )
+        {
+            return static_cast<int>(k);
+        }
+    }
+}
+
+//! Gamma variate of integer shape and given scale: zero (with no draws)
+//! if shape≤0; a sum of exponentials for small shape;
+//! Marsaglia-Tsang squeeze/rejection otherwise
+template<typename urbg_t>
+inline double sample_gamma(const int shape, const double scale, urbg_t& urbg)
+{
+    if (shape<=0) { return 0.0; }
+    if (shape<=3)
+    {
+        auto product = sample_uniform(urbg);
+        for (auto i=1; i<shape; i++) { product *= sample_uniform(urbg); }
+        return -std::log(product)*scale;
+    }
+    const auto d = shape - 1.0/3.0;
+    const auto c = 1/std::sqrt(9*d);
+    while (true)
+    {
+        const auto x = sample_gaussian(urbg);
+        auto v = 1 + c*x;
+        if (v<=0) { continue; }
+        v = v*v*v;
+        const auto u = sample_uniform(urbg);
+        const auto x2 = x*x;
+        if (u<1-0.0331*x2*x2) { return d*v*scale; }
+        if (std::log(u)<0.5*x2 + d*(1-v+std::log(v))) { return d*v*scale; }
+    }
+}
+
+#endif
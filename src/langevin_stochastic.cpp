@@ -0,0 +1,59 @@
+/**
+ * @file langevin_stochastic.cpp
+ * @brief Methods to carry out the Dornic stochastic (Poisson-gamma) step.
+ */
+
+#include "langevin_types.hpp"
+#include "langevin_integrator.hpp"
+
+//! Stochastic step for cells i_begin...i_end-1 of `grid`, in place, 
+//! drawing in cell order from the single shared rng; 
+//! the new densities are added to density_sum
+template<typename real_t>
+void Langevin<real_t>::stochastic_block(
+    grid_t& grid, const int i_begin, const int i_end, 
+    rng_t& rng, double& density_sum
+) const
+{
+    auto sum = density_sum;
+    for (auto i=i_begin; i<i_end; i++)
+    {
+        grid[i] = stochastic_step(grid[i], rng);
+        sum += grid[i];
+    }
+    density_sum = sum;
+}
+
+//! Stochastic step for cells i_begin...i_end-1 of `grid`, in place, 
+//! drawing from a Philox stream keyed on the random seed, 
+//! the integration step and the cell index (in the whole grid, if it's
+//! decomposed): the result for each cell is thus independent of visit 
+//! order, of which thread does the work, and of which process;
+//! the new densities are added to density_sum
+template<typename real_t>
+void Langevin<real_t>::stochastic_block(
+    grid_t& grid, const int i_begin, const int i_end, double& density_sum
+) const
+{
+    auto sum = density_sum;
+    for (auto i=i_begin; i<i_end; i++)
+    {
+        PhiloxStream urbg(random_seed, i_step, i_first_cell+i);
+        grid[i] = stochastic_step(grid[i], urbg);
+        sum += grid[i];
+    }
+    density_sum = sum;
+}
+
+template void Langevin<float>::stochastic_block(
+    grid_t&, const int, const int, rng_t&, double&
+) const;
+template void Langevin<double>::stochastic_block(
+    grid_t&, const int, const int, rng_t&, double&
+) const;
+template void Langevin<float>::stochastic_block(
+    grid_t&, const int, const int, double&
+) const;
+template void Langevin<double>::stochastic_block(
+    grid_t&, const int, const int, double&
+) const;
@@ -0,0 +1,87 @@
+/**
+ * @file langevin_threads.cpp
+ * @brief Methods of the small thread pool used by the integrators.
+ */
+
+#include "langevin_threads.hpp"
+
+ThreadPool::ThreadPool(int n_threads) : i_next_task(0)
+{
+    if (n_threads<=0) 
+    { 
+        n_threads = static_cast<int>(std::thread::hardware_concurrency()); 
+    }
+    for (auto i=1; i<n_threads; i++)
+    {
+        workers.push_back(std::thread(&ThreadPool::work, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        do_stop = true;
+    }
+    cv_start.notify_all();
+    for (auto& worker : workers) { worker.join(); }
+}
+
+int ThreadPool::get_n_threads() const 
+{ 
+    return static_cast<int>(workers.size())+1; 
+}
+
+void ThreadPool::run_tasks()
+{
+    for (auto i = i_next_task++; i<n_tasks; i = i_next_task++)
+    {
+        (*task)(i);
+    }
+}
+
+void ThreadPool::work()
+{
+    unsigned long i_seen_generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv_start.wait(lock, [&]()
+            { 
+                return do_stop or i_generation!=i_seen_generation; 
+            });
+            if (do_stop) { return; }
+            i_seen_generation = i_generation;
+        }
+        run_tasks();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--n_busy==0) { cv_done.notify_one(); }
+        }
+    }
+}
+
+void ThreadPool::parallel_for(
+    const int n_tasks, const std::function<void(int)>& task
+)
+{
+    if (workers.empty() or n_tasks<=1)
+    {
+        for (auto i=0; i<n_tasks; i++) { task(i); }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->task = &task;
+        this->n_tasks = n_tasks;
+        i_next_task = 0;
+        n_busy = static_cast<int>(workers.size());
+        i_generation++;
+    }
+    cv_start.notify_all();
+    run_tasks();
+    std::unique_lock<std::mutex> lock(mutex);
+    cv_done.wait(lock, [&](){ return n_busy==0; });
+    this->task = nullptr;
+}
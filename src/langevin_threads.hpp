@@ -0,0 +1,70 @@
+/**
+ * @file langevin_threads.hpp
+ * @brief Small thread pool used to split integration sweeps across cores.
+ */
+
+#ifndef THREADS_HPP
+#define THREADS_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Small thread pool used to split integration sweeps across cores.
+ *
+ * The pool keeps `n_threads-1` worker threads parked between calls to 
+ * `parallel_for`; the calling thread does its share of the work too. 
+ * Tasks are handed out one at a time from a shared counter, so a thread
+ * that finishes early simply picks up the next task. 
+ * A pool of one thread runs every task directly in the calling thread.
+ *
+ * Calls to `parallel_for` must not be nested or made concurrently.
+ */
+class ThreadPool
+{
+private:
+    //! Parked worker threads
+    std::vector<std::thread> workers;
+    //! Guards the task hand-off state below
+    std::mutex mutex;
+    //! Signals workers that a new set of tasks is ready (or to stop)
+    std::condition_variable cv_start;
+    //! Signals the caller that all workers have finished their tasks
+    std::condition_variable cv_done;
+    //! Task function for the current `parallel_for` call
+    const std::function<void(int)>* task = nullptr;
+    //! Number of tasks in the current `parallel_for` call
+    int n_tasks = 0;
+    //! Index of the next task to be picked up
+    std::atomic<int> i_next_task;
+    //! Number of workers still busy with the current set of tasks
+    int n_busy = 0;
+    //! Count of `parallel_for` calls, used to wake workers exactly once each
+    unsigned long i_generation = 0;
+    //! Flag telling workers to exit
+    bool do_stop = false;
+
+    //! Pick up and run tasks until there are none left
+    void run_tasks();
+    //! Worker thread main loop
+    void work();
+
+public:
+    //! Constructor: n_threads<=0 means one thread per hardware core
+    explicit ThreadPool(int n_threads);
+    //! Destructor: stops and joins all worker threads
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //! Total number of threads doing work, including the caller's
+    int get_n_threads() const;
+    //! Run `task(i)` for i=0...n_tasks-1 across the pool and wait for all
+    void parallel_for(const int n_tasks, const std::function<void(int)>& task);
+};
+
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file langevin_tridiagonal.hpp
+ * @brief Implicit (backward-Euler) diffusion along the lines of one grid axis.
+ */
+
+#ifndef TRIDIAGONAL_HPP
+#define TRIDIAGONAL_HPP
+
+#include <algorithm>
+#include "langevin_types.hpp"
+
+/**
+ * @brief Implicit (backward-Euler) diffusion along the lines of one grid axis.
+ *
+ * Solves (1 + n_i r) x_i - r Σ_j x_j = d_i along a line of n cells, where
+ * r = DΔt/Δx², and the sum is over the n_i neighbors of cell i along the
+ * line: the system is tridiagonal if the axis is bounded (end cells having
+ * one neighbor, as in the explicit stencil), and cyclic tridiagonal if
+ * it is periodic. Its LU factors depend only on n and r, so they're
+ * computed once and used for every line and every step. A cyclic system
+ * is solved by the Sherman-Morrison formula: a tridiagonal solve, followed
+ * by a correction along a vector also computed just once.
+ *
+ * Lines are solved in strips of up to `n_strip_lines` adjacent lines at
+ * once: element i of line b lies at data[i*stride + b], so lines along y
+ * or z are swept with unit stride in the innermost loop, which vectorizes.
+ */
+struct DiffusionLineSolver
+{
+    //! Greatest number of adjacent lines solved together
+    static const int n_strip_lines = 64;
+    //! Number of cells along each line (no diffusion if fewer than two)
+    int n = 1;
+    //! Coupling -r between neighboring cells (2r if two cells link twice)
+    double coupling = 0;
+    //! Flag: lines wrap around (cyclic system)
+    bool is_cyclic = false;
+    //! Reciprocals of the pivots of the LU factorization
+    dbl_vec_t inv_pivots;
+    //! Back-substitution factors, coupling/pivot
+    dbl_vec_t uppers;
+    //! Sherman-Morrison correction vector (cyclic systems only)
+    dbl_vec_t corrections;
+    //! Sherman-Morrison weight of the last cell of each line
+    double last_weight = 0;
+    //! Sherman-Morrison denominator
+    double denominator = 1;
+
+    //! Factorize the system for lines of n cells, given r = DΔt/Δx², and whether they wrap around
+    void factorize(const int n, const double r, const bool is_periodic);
+    //! Solve, in place, the n_lines (≤ n_strip_lines) adjacent lines starting at `data`
+    template<typename real_t>
+    void solve(real_t* data, const int stride, const int n_lines) const;
+};
+
+/**
+ * @details Forward elimination and back substitution, line by line in step,
+ * then the Sherman-Morrison correction if the lines wrap around: the
+ * weight of each line's correction is found from its first and last cells
+ * before either is corrected. Arithmetic is in double precision.
+ */
+template<typename real_t>
+void DiffusionLineSolver::solve(
+    real_t* data, const int stride, const int n_lines
+) const
+{
+    if (n<2) { return; }
+    for (auto b=0; b<n_lines; b++) { data[b] *= inv_pivots[0]; }
+    for (auto i=1; i<n; i++)
+    {
+        real_t* const row = data + static_cast<size_t>(i)*stride;
+        const real_t* const previous = row - stride;
+        const auto inv_pivot = inv_pivots[i];
+        for (auto b=0; b<n_lines; b++)
+        {
+            row[b] = (row[b] + coupling*previous[b])*inv_pivot;
+        }
+    }
+    for (auto i=n-2; i>=0; i--)
+    {
+        real_t* const row = data + static_cast<size_t>(i)*stride;
+        const real_t* const next = row + stride;
+        const auto upper = uppers[i];
+        for (auto b=0; b<n_lines; b++) { row[b] += upper*next[b]; }
+    }
+    if (not is_cyclic) { return; }
+    double weights[n_strip_lines];
+    const real_t* const last = data + static_cast<size_t>(n-1)*stride;
+    for (auto b=0; b<n_lines; b++)
+    {
+        weights[b] = (data[b] + last_weight*last[b]) / denominator;
+    }
+    for (auto i=0; i<n; i++)
+    {
+        real_t* const row = data + static_cast<size_t>(i)*stride;
+        const auto correction = corrections[i];
+        for (auto b=0; b<n_lines; b++) { row[b] -= weights[b]*correction; }
+    }
+}
+
+#endif
@@ -7,9 +7,9 @@
 #define CORE_HPP
 
 #include <iostream>
+#include <cmath>
 #include <vector>
 #include <random>
-#include <pybind11/numpy.h>
 #include <valarray>
 
 //! Use Mersenne Twister random number generator
@@ -20,16 +20,10 @@ typedef std::vector<double> dbl_vec_t;
 //! Type for vectors of integers
 typedef std::vector<int> int_vec_t;
 
-//! Type for density grid
-typedef std::vector<double> grid_t;
-// typedef std::valarray<double> grid_t;  // doesn't work
-
-//! Type for density grid wiring
+//! Type for the neighbor indexes of a single grid cell
 typedef std::vector<int> neighborhood_t;
-//! Type for grid-cell neighborhood connections
-typedef std::vector< neighborhood_t > grid_wiring_t;
-// typedef std::valarray<int> grid_connection_t;  // doesn't work
-// typedef std::valarray< grid_connection_t > grid_wiring_t;  // doesn't work
+//! Type for per-cell neighborhood lists, used while wiring up a grid
+typedef std::vector< neighborhood_t > neighborhoods_t;
 
 //! Type for function generating Poisson variates
 typedef std::poisson_distribution<int> poisson_dist_t;
@@ -44,9 +38,11 @@ typedef std::uniform_real_distribution<double> uniform_dist_t;
 //! Type for specifying grid topology in each direction x, y, z...
 typedef std::vector<GridTopology> gt_vec_t;
 typedef std::vector<BoundaryCondition> bc_vec_t;
+//! Type for specifying a set of observables to measure
+typedef std::vector<Observable> obs_vec_t;
 
-namespace py = pybind11;
-//! Type for Python arrays of doubles
-typedef py::array_t<double, py::array::c_style> py_array_t;
+#include "langevin_wiring.hpp"
+//! Type for compact density grid wiring: neighborhood connections of all cells
+typedef GridWiring grid_wiring_t;
 
 #endif
\ No newline at end of file
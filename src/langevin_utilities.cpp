@@ -3,24 +3,124 @@
  * @brief Utility methods to process the Langevin field grid.
  */
 
+#include <algorithm>
 #include "langevin_types.hpp"
-#include "langevin_base.hpp"
+#include "langevin_integrator.hpp"
 
 //! Return the Langevin density field grid value at a given "node"
-double BaseLangevin::get_density_grid_value(const int i) const 
+template<typename real_t>
+double Langevin<real_t>::get_density_grid_value(const int i) const
 {
     return density_grid[i];
 }
 
+//! Copy the density field, subsampled by taking every `stride`-th cell 
+//! of every `stride`-th row, into `frame` row by row: so `frame` holds
+//! ceil(n_y/stride) x ceil(n_x/stride) values, with x varying fastest.
+//! A 3D grid is represented by its middle z-plane.
+template<typename real_t>
+void Langevin<real_t>::copy_density_grid(const int stride, double* frame) const
+{
+    const auto i_plane = (n_z/2)*n_x*n_y;
+    for (auto y=0; y<n_y; y+=stride)
+    {
+        const auto row = density_grid.begin() + i_plane + y*n_x;
+        if (stride==1) 
+        { 
+            frame = std::copy(row, row+n_x, frame); 
+            continue;
+        }
+        for (auto x=0; x<n_x; x+=stride) { *frame++ = row[x]; }
+    }
+}
+
+//! Write the density field grid's n_cells values, as stored, to `file`
+template<typename real_t>
+bool Langevin<real_t>::write_density_grid(std::FILE* file) const
+{
+    return (
+        std::fwrite(density_grid.data(), sizeof(real_t), n_cells, file)
+            ==static_cast<size_t>(n_cells)
+    );
+}
+
+//! Read the density field grid's n_cells values, as stored, from `file`,
+//! and note which blocks are now occupied
+template<typename real_t>
+bool Langevin<real_t>::read_density_grid(std::FILE* file)
+{
+    if (
+        std::fread(density_grid.data(), sizeof(real_t), n_cells, file)
+            !=static_cast<size_t>(n_cells)
+    )
+    {
+        return false;
+    }
+    find_occupied_blocks();
+    return true;
+}
+
 //! Return the grid-averaged Langevin field mean value
 double BaseLangevin::get_mean_density() const
 {
     return mean_density;
 }
 
+//! Return the count of integration steps taken, which keys the 
+//! counter-based random number streams
+std::uint64_t BaseLangevin::get_i_step() const
+{
+    return i_step;
+}
+
+//! Restore the step count and grid-averaged density, e.g., when resuming
+//! from a checkpoint
+void BaseLangevin::set_step_state(
+    const std::uint64_t i_step, const double mean_density
+)
+{
+    this->i_step = i_step;
+    this->mean_density = mean_density;
+}
+
 //! Compute the mean field density times "lamba_product", 
 //! which should be equal to the Poisson distribution mean
 double BaseLangevin::get_poisson_mean() const
 {
     return lambda_on_explcdt * mean_density;
-}
\ No newline at end of file
+}
+
+//! Return the time step Δt of the next integration step
+double BaseLangevin::get_dt() const
+{
+    return dt;
+}
+
+//! Choose whether each Runge-Kutta step estimates the local error of its
+//! deterministic update, block by block, e.g., to adapt Δt
+void BaseLangevin::set_error_estimation(const bool do_estimate_error)
+{
+    this->do_estimate_error = do_estimate_error;
+    block_errors.assign(do_estimate_error ? n_blocks() : 0, 0.0);
+}
+
+//! Return the largest scaled local error estimate of the latest Runge-Kutta
+//! step over the blocks it integrated (the others were empty, and unchanged)
+double BaseLangevin::get_step_error() const
+{
+    double error = 0;
+    for (const auto i_block : active_blocks)
+    {
+        error = std::max(error, block_errors[i_block]);
+    }
+    return error;
+}
+
+template double Langevin<float>::get_density_grid_value(const int) const;
+template double Langevin<double>::get_density_grid_value(const int) const;
+template void Langevin<float>::copy_density_grid(const int, double*) const;
+template bool Langevin<float>::write_density_grid(std::FILE*) const;
+template bool Langevin<double>::write_density_grid(std::FILE*) const;
+template bool Langevin<float>::read_density_grid(std::FILE*);
+template bool Langevin<double>::read_density_grid(std::FILE*);
+template void Langevin<double>::copy_density_grid(const int, double*) const;
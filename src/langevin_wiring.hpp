@@ -0,0 +1,60 @@
+/**
+ * @file langevin_wiring.hpp
+ * @brief Compact container for density-grid cell-cell topology.
+ */
+
+#ifndef WIRING_HPP
+#define WIRING_HPP
+
+/**
+ * @brief Compact container for density-grid cell-cell topology.
+ *
+ * The neighbor indexes of all grid cells are packed into one flat vector
+ * in "compressed sparse row" form: the neighbors of cell i are found at
+ * `neighbors[offsets[i]]` ... `neighbors[offsets[i+1]-1]`.
+ * This replaces one heap-allocated neighbor vector per cell, so that
+ * sweeping over the grid reads the wiring as a single contiguous stream.
+ *
+ * Grid construction methods build a per-cell neighborhood list (which is
+ * convenient when wiring edges and corners out of order) and then
+ * compress it into this container.
+ */
+struct GridWiring
+{
+public:
+    //! Index into `neighbors` of the first neighbor of each cell (plus end)
+    int_vec_t offsets;
+    //! Neighbor cell indexes of all cells, concatenated
+    int_vec_t neighbors;
+
+    GridWiring() = default;
+    GridWiring(const neighborhoods_t& neighborhoods)
+    {
+        const auto n_cells = static_cast<int>(neighborhoods.size());
+        offsets = int_vec_t(n_cells+1, 0);
+        for (auto i=0; i<n_cells; i++)
+        {
+            offsets[i+1] = offsets[i] + neighborhoods[i].size();
+        }
+        neighbors.reserve(offsets[n_cells]);
+        for (const auto& neighborhood : neighborhoods)
+        {
+            neighbors.insert(
+                neighbors.end(), neighborhood.begin(), neighborhood.end()
+            );
+        }
+    }
+
+    //! Number of grid cells wired up
+    int n_cells() const { return static_cast<int>(offsets.size())-1; }
+    //! Number of neighbors of cell i
+    int n_neighbors(const int i) const { return offsets[i+1]-offsets[i]; }
+    //! Pointer to the first neighbor index of cell i
+    const int* begin(const int i) const 
+        { return neighbors.data() + offsets[i]; }
+    //! Pointer to one past the last neighbor index of cell i
+    const int* end(const int i) const 
+        { return neighbors.data() + offsets[i+1]; }
+};
+
+#endif
@@ -0,0 +1,60 @@
+/**
+ * @file langevin_wiring_cache.cpp
+ * @brief Methods of the process-wide cache of grid wirings.
+ */
+
+#include <algorithm>
+#include "langevin_wiring_cache.hpp"
+
+//! Created on first use, which C++11 makes thread-safe
+GridWiringCache& GridWiringCache::instance()
+{
+    static GridWiringCache cache;
+    return cache;
+}
+
+//! Only the topologies of the grid's own axes are part of the key
+int_vec_t GridWiringCache::key(
+    const GridDimension grid_dimension,
+    const int n_x, const int n_y, const int n_z,
+    const gt_vec_t& grid_topologies
+)
+{
+    int_vec_t grid_key = {static_cast<int>(grid_dimension), n_x, n_y, n_z};
+    const auto n_topologies = std::min(
+        grid_topologies.size(), static_cast<size_t>(grid_dimension)
+    );
+    for (size_t i=0; i<n_topologies; i++)
+    {
+        grid_key.push_back(static_cast<int>(grid_topologies[i]));
+    }
+    return grid_key;
+}
+
+std::shared_ptr<const grid_wiring_t> GridWiringCache::find(const int_vec_t& key)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto entry = wirings.find(key);
+    if (entry==wirings.end()) { return nullptr; }
+    return entry->second.lock();
+}
+
+//! Two integrators may have wired the same grid at once: the first to
+//! cache its wiring wins, and the other adopts it, dropping its own.
+//! Entries of wirings no longer in use are cleared out here.
+std::shared_ptr<const grid_wiring_t> GridWiringCache::insert(
+    const int_vec_t& key, const std::shared_ptr<const grid_wiring_t>& wiring
+)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto entry=wirings.begin(); entry!=wirings.end(); )
+    {
+        if (entry->second.expired()) { entry = wirings.erase(entry); }
+        else { entry++; }
+    }
+    auto& cached = wirings[key];
+    const auto cached_wiring = cached.lock();
+    if (cached_wiring) { return cached_wiring; }
+    cached = wiring;
+    return wiring;
+}
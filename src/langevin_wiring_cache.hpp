@@ -0,0 +1,56 @@
+/**
+ * @file langevin_wiring_cache.hpp
+ * @brief Process-wide cache of the cell wirings of grids in use, shared
+ * by all integrators of identical grids.
+ */
+
+#ifndef WIRING_CACHE_HPP
+#define WIRING_CACHE_HPP
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include "langevin_types.hpp"
+
+/**
+ * @brief Process-wide cache of the cell wirings of grids in use, shared
+ * by all integrators of identical grids.
+ *
+ * A grid's wiring depends only on its dimension, size and edge topologies,
+ * and is never modified once built: so every integrator of the same kind
+ * of grid, e.g., every replica of an ensemble, can share one read-only
+ * copy of it, which on a large 2D grid takes more memory than the density
+ * field itself. The cache holds only weak references, keyed on
+ * (dimension, n_x, n_y, n_z, topologies): a wiring lives as long as some
+ * integrator still holds it, and is wired afresh once none does.
+ *
+ * Lookups are guarded by a mutex, so integrators in different threads
+ * can construct their grids at once. Slabs of decomposed grids are
+ * wired on their own, and not cached.
+ */
+class GridWiringCache
+{
+private:
+    //! Guards the cache entries
+    std::mutex mutex;
+    //! Wirings of grids in use, by grid key
+    std::map< int_vec_t, std::weak_ptr<const grid_wiring_t> > wirings;
+
+public:
+    //! The cache shared by all integrators in this process
+    static GridWiringCache& instance();
+    //! Key of a grid: its dimension, numbers of cells along x, y and z, and the topologies of its edges
+    static int_vec_t key(
+        const GridDimension grid_dimension,
+        const int n_x, const int n_y, const int n_z,
+        const gt_vec_t& grid_topologies
+    );
+    //! Fetch the wiring of a grid in use with this key, if any (else null)
+    std::shared_ptr<const grid_wiring_t> find(const int_vec_t& key);
+    //! Cache a newly built wiring, unless one with the same key was cached meanwhile, and return the wiring cached
+    std::shared_ptr<const grid_wiring_t> insert(
+        const int_vec_t& key, const std::shared_ptr<const grid_wiring_t>& wiring
+    );
+};
+
+#endif
@@ -22,7 +22,10 @@
     const InitialCondition initial_condition,
     const dbl_vec_t ic_values,
     const IntegrationMethod integration_method,
-    const bool do_verbose
+    const bool do_verbose,
+    const RandomGenerator random_generator,
+    const Precision precision,
+    const int n_threads
 ) : coefficients(linear, quadratic, diffusion, noise),
     p(
         t_final, 
@@ -36,25 +39,48 @@
         bc_values,
         initial_condition, 
         ic_values, 
-        integration_method
+        integration_method,
+        random_generator,
+        precision
     ),
     do_verbose(do_verbose)
 {
     rng = new rng_t(p.random_seed); 
-    dpLangevin = new DPLangevin(p);
+    switch (p.precision)
+    {
+        case (Precision::FLOAT32):
+            dpLangevin = new DPLangevin<float>(p);
+            break;
+        default:
+            dpLangevin = new DPLangevin<double>(p);
+    }
+    thread_pool = new ThreadPool(n_threads);
+    dpLangevin->set_thread_pool(thread_pool);
     if (do_verbose) 
     {
         coefficients.print();
         p.print();
+        std::cout << "n_threads: " << thread_pool->get_n_threads() << std::endl;
     }
 }
 
+//! Destructor: wait for any background run to finish, then release 
+//! the integrator, rng and thread pool
+SimDP::~SimDP()
+{
+    if (async_result.valid()) { async_result.wait(); }
+    delete dpLangevin;
+    delete thread_pool;
+    delete rng;
+}
+
 //! Method to be called first to set up simulation: 
 //! a grid is constructed; initial conditions are applied; 
 //! the Langevin equation is prepared; the zeroth-epoch 
 //! solution state is recorded (after applying boundary conditions).
 bool SimDP::initialize(int n_decimals)
 {
+    if (is_busy("initialize")) { return false; }
     if (not dpLangevin->construct_grid(p)) { 
         std::cout 
             << "SimDP::initialize failure: couldn't construct grid" 
@@ -68,12 +94,24 @@ bool SimDP::initialize(int n_decimals)
         return false; 
     }
     dpLangevin->prepare(coefficients);
+    // Steps are of fixed Δt unless adaptive stepping is chosen afresh
+    is_adaptive = false;
+    dpLangevin->set_dt(p.dt);
+    dpLangevin->set_error_estimation(false);
     this->n_decimals = n_decimals;
+    decimals_scale = std::pow(10, n_decimals);
     n_epochs = count_epochs();
-    t_epochs = dbl_vec_t(n_epochs, 0.0);
-    mean_densities = dbl_vec_t(n_epochs, 0.0);
+    // Fresh vectors: views of any previous time series keep their own
+    t_epochs = std::make_shared<dbl_vec_t>(n_epochs, 0.0);
+    mean_densities = std::make_shared<dbl_vec_t>(n_epochs, 0.0);
+    // Observables must be chosen afresh for the new grid
+    observables.clear();
+    observable_series.clear();
+    dpLangevin->set_observables(p, observables);
     // Treat epoch#0 as the initial grid state
     // So after initialization, we are nominally at epoch#1
+    i_current_epoch = 0;
+    t_current_epoch = 0;
     i_next_epoch = 1;
     t_next_epoch = p.dt;
     if (not choose_integrator())
@@ -86,6 +124,7 @@ bool SimDP::initialize(int n_decimals)
         std::cout << "SimDP::initialize failure: wrong number of boundary conditions" << std::endl;
         return false;
     }
+    dpLangevin->plan_boundary_conditions(p);
     is_initialized = true;
     return is_initialized;
 }
@@ -101,14 +140,251 @@ bool SimDP::run(const int n_next_epochs)
         std::cout << "SimDP::run failure: must initialize first" << std::endl;
         return false; 
     }
+    if (is_busy("run")) { return false; }
     did_integrate = integrate(n_next_epochs);
     return did_integrate;
 }
 
-//! Method to be called after each `run`: the density grid and grid-average time 
-//! series are then packed and made available to Python through the wrapper.
-//! This method should be called every time a "snapshot" of the simulation
-//! state is desired.
+//! Method to carry out a set of integration steps, as with `run`, but in a
+//! background thread: it returns at once with a handle on the run, which
+//! can be polled or waited on. Until the run has finished, this simulation
+//! refuses to initialize, run or postprocess.
+SimDPRun SimDP::run_async(const int n_next_epochs)
+{
+    auto n_epochs_done = std::make_shared< std::atomic<int> >(0);
+    if (not is_initialized) 
+    { 
+        std::cout << "SimDP::run_async failure: must initialize first" << std::endl;
+    }
+    if (not is_initialized or is_busy("run_async"))
+    {
+        std::promise<bool> failure;
+        failure.set_value(false);
+        return SimDPRun(failure.get_future().share(), n_epochs_done, 0);
+    }
+    async_result = std::async(
+        std::launch::async,
+        [this, n_next_epochs, n_epochs_done]() -> bool
+        {
+            did_integrate = integrate(n_next_epochs, n_epochs_done.get());
+            return did_integrate;
+        }
+    ).share();
+    return SimDPRun(async_result, n_epochs_done, n_next_epochs);
+}
+
+/**
+ * @details Choose grid-wide observables (see BaseLangevin::get_observable) 
+ * to be measured at every epoch, from the current epoch on, and kept as 
+ * time series like that of the mean density. Their moments are gathered 
+ * block by block within the integration sweeps themselves, while each 
+ * block is still in cache, so measuring them costs no extra pass over 
+ * the grid. Any previous choice is dropped (but its time series stay 
+ * valid for Python views of them), and an empty list turns measurement off.
+ *
+ * Must be called after `initialize`. Observable time series are not
+ * saved in checkpoints.
+ */
+bool SimDP::set_observables(const obs_vec_t& observables)
+{
+    if (not is_initialized) 
+    { 
+        std::cout << "SimDP::set_observables failure: must initialize first" << std::endl;
+        return false; 
+    }
+    if (is_busy("set_observables")) { return false; }
+    this->observables = observables;
+    observable_series.clear();
+    for (size_t i=0; i<observables.size(); i++)
+    {
+        observable_series.push_back(
+            std::make_shared<dbl_vec_t>(t_epochs->size(), 0.0)
+        );
+    }
+    dpLangevin->set_observables(p, observables);
+    // Measure the grid as it is now, so the first step starts from
+    // valid moments in every block
+    dpLangevin->find_occupied_blocks();
+    if (i_next_epoch>1) { record_observables(i_current_epoch); }
+    return true;
+}
+
+/**
+ * @details Set up recording of the density grid, from epoch#0 onwards,
+ * every `n_epochs_per_frame` epochs, into frames preallocated here for the
+ * whole simulation: so recording costs one copy of the grid per frame, 
+ * made during `run` itself. Frames are subsampled by taking every
+ * `stride`-th cell in x and in y. Frames of epochs not (yet) recorded
+ * are zero. Any previous recording is dropped (but stays valid for 
+ * Python views of it), and `n_epochs_per_frame=0` turns recording off.
+ *
+ * Must be called after `initialize`. The grid at the current epoch is 
+ * recorded right away if it falls on a frame.
+ */
+bool SimDP::set_frame_recorder(const int n_epochs_per_frame, const int stride)
+{
+    if (not is_initialized) 
+    { 
+        std::cout << "SimDP::set_frame_recorder failure: must initialize first" << std::endl;
+        return false; 
+    }
+    if (is_busy("set_frame_recorder")) { return false; }
+    if (n_epochs_per_frame<0 or stride<1)
+    {
+        std::cout << "SimDP::set_frame_recorder failure: bad frame spacing" << std::endl;
+        return false; 
+    }
+    this->n_epochs_per_frame = n_epochs_per_frame;
+    frame_stride = stride;
+    if (n_epochs_per_frame==0)
+    {
+        n_frames = 0;
+        frames = std::make_shared<dbl_vec_t>();
+        return true;
+    }
+    n_frames = (n_epochs-1)/n_epochs_per_frame + 1;
+    n_frame_y = (p.n_y + stride-1)/stride;
+    n_frame_x = (p.n_x + stride-1)/stride;
+    // Room for frames of all epochs allotted so far (which may be more 
+    // than have been integrated, in adaptive runs)
+    const auto n_frames_allotted = (
+        static_cast<int>(t_epochs->size())-1
+    )/n_epochs_per_frame + 1;
+    frames = std::make_shared<dbl_vec_t>(
+        static_cast<size_t>(n_frames_allotted)*n_frame_y*n_frame_x, 0.0
+    );
+    if (i_next_epoch>1) { record_frame(i_current_epoch); }
+    return true;
+}
+
+/**
+ * @details Adapt the time step epoch by epoch during subsequent runs,
+ * instead of taking steps of fixed Δt: each step is as long as the local 
+ * error estimate of the previous one allows, given `error_tolerance`,
+ * within the stability limit of explicit Runge-Kutta diffusion, and
+ * between `dt_min` (if 0, Δt/2^16) and the Δt of the model parameters.
+ * Steps are taken from a ladder Δt·2^(-k/4), so their Dornic coefficients
+ * are computed just once each; steps are never rejected, since the 
+ * stochastic step of each has already drawn its random numbers.
+ *
+ * Each epoch is then one adaptive step, and the time series record the
+ * actual time of each. So the number of epochs isn't known in advance: 
+ * each `run(n)` integrates up to n epochs, stopping early at t_final
+ * (which the last step is cut short to hit exactly), and `get_n_epochs`
+ * counts the epochs integrated so far, the time series being enlarged
+ * as needed.
+ *
+ * Must be called after `initialize` and before the first `run`, and
+ * only for the stage-by-stage Runge-Kutta method. Adaptive runs can't
+ * be checkpointed.
+ */
+bool SimDP::set_adaptive_dt(const double error_tolerance, const double dt_min)
+{
+    if (not is_initialized or i_next_epoch>1) 
+    { 
+        std::cout << "SimDP::set_adaptive_dt failure: must initialize first, and not run yet" << std::endl;
+        return false; 
+    }
+    if (is_busy("set_adaptive_dt")) { return false; }
+    if (p.integration_method!=IntegrationMethod::RUNGE_KUTTA)
+    {
+        std::cout << "SimDP::set_adaptive_dt failure: only for the RUNGE_KUTTA method" << std::endl;
+        return false; 
+    }
+    if (error_tolerance<=0 or dt_min<0 or dt_min>p.dt)
+    {
+        std::cout << "SimDP::set_adaptive_dt failure: bad tolerance or minimum time step" << std::endl;
+        return false; 
+    }
+    is_adaptive = true;
+    this->error_tolerance = error_tolerance;
+    this->dt_min = (dt_min>0) ? dt_min : p.dt/65536;
+    dpLangevin->set_error_estimation(true);
+    // Start with the longest step the stability limit allows
+    const auto stiffness = dpLangevin->get_stiffness();
+    dt_next = choose_dt(
+        (stiffness>0) ? rk4_stability_limit/stiffness : p.dt
+    );
+    n_epochs = 1;
+    if (n_epochs_per_frame>0) { n_frames = 1; }
+    t_next_epoch = std::min(dt_next, p.t_final);
+    return true;
+}
+
+/**
+ * @details Start streaming output to disk: from the current epoch on,
+ * each epoch's time and mean density, and every `n_epochs_per_frame`
+ * epochs (if nonzero) the density grid, subsampled by `stride`, are handed 
+ * to a writer thread which appends them to files at `path_stem` 
+ * (see SimDPStream for the file format). 
+ *
+ * Must be called after `initialize`; the stream stays open across runs
+ * until `close_stream` is called (or the simulation is deleted).
+ */
+bool SimDP::open_stream(
+    const std::string& path_stem, 
+    const int n_epochs_per_frame, const int stride
+)
+{
+    if (not is_initialized) 
+    { 
+        std::cout << "SimDP::open_stream failure: must initialize first" << std::endl;
+        return false; 
+    }
+    if (is_busy("open_stream")) { return false; }
+    if (stream.is_open() or n_epochs_per_frame<0 or stride<1)
+    {
+        std::cout << "SimDP::open_stream failure: stream already open or bad frame spacing" << std::endl;
+        return false; 
+    }
+    n_epochs_per_stream_frame = n_epochs_per_frame;
+    stream_stride = stride;
+    const attributes_t attributes = {
+        {"linear", coefficients.linear},
+        {"quadratic", coefficients.quadratic},
+        {"diffusion", coefficients.diffusion},
+        {"noise", coefficients.noise},
+        {"t_final", p.t_final},
+        {"dx", p.dx},
+        {"dt", p.dt},
+        {"random_seed", p.random_seed},
+        {"n_x", p.n_x},
+        {"n_y", p.n_y},
+        {"n_z", p.n_z},
+        {"n_epochs", n_epochs},
+        {"n_epochs_per_frame", n_epochs_per_frame},
+        {"stride", stride},
+    };
+    if (not stream.open(
+        path_stem,
+        (p.n_y + stride-1)/stride, (p.n_x + stride-1)/stride,
+        attributes
+    ))
+    {
+        std::cout << "SimDP::open_stream failure: couldn't create files" << std::endl;
+        return false; 
+    }
+    if (i_next_epoch>1) { stream_epoch(i_current_epoch); }
+    return true;
+}
+
+//! Close the output stream once everything handed over has been written
+bool SimDP::close_stream()
+{
+    if (is_busy("close_stream")) { return false; }
+    if (not stream.close())
+    {
+        std::cout << "SimDP::close_stream failure: stream not open or write failed" << std::endl;
+        return false; 
+    }
+    return true;
+}
+
+//! Method to be called after each `run`: the grid-average time series (and
+//! observables and frames) are then made available to Python through the 
+//! wrapper, as read-only views of the simulation's own buffers, so nothing
+//! is copied here. The density grid itself is fetched on demand, by
+//! `get_density` or `get_density_view`.
 bool SimDP::postprocess()
 {
     if (not is_initialized) 
@@ -116,8 +392,10 @@ bool SimDP::postprocess()
         std::cout << "SimDP::postprocess failure: no data to process yet" << std::endl;
         return false; 
     }
+    if (is_busy("postprocess")) { return false; }
     bool did_process = (
-        pyprep_density_grid() and pyprep_t_epochs() and pyprep_mean_densities() 
+        pyprep_t_epochs() and pyprep_mean_densities() 
+        and pyprep_observables() and pyprep_frames()
     ); 
     return did_process;
 }
\ No newline at end of file
@@ -6,7 +6,54 @@
 #ifndef SIMDP_HPP
 #define SIMDP_HPP
 
+#include <atomic>
+#include <future>
+#include <memory>
+#include <pybind11/numpy.h>
 #include "dplangevin.hpp"
+#include "sim_dplangevin_stream.hpp"
+#include "sim_dplangevin_checkpoint.hpp"
+
+namespace py = pybind11;
+//! Type for Python arrays of doubles
+typedef py::array_t<double, py::array::c_style> py_array_t;
+//! Largest Δt, times the fastest decay rate of the RHS, for which explicit 
+//! 4th-order Runge-Kutta is stable (≈2.785), less a safety margin
+const double rk4_stability_limit = 2.5;
+
+/**
+ * @brief Handle on a simulation run started by `SimDP::run_async`.
+ *
+ * The run carries on in a background thread; the handle reports whether 
+ * it has finished, waits for it, and counts the epochs integrated so far.
+ * Copies of a handle all refer to the same run.
+ */
+class SimDPRun
+{
+private:
+    //! Result of the run: whether integration was successful
+    std::shared_future<bool> result;
+    //! Number of epochs integrated so far, updated by the running thread
+    std::shared_ptr< std::atomic<int> > n_epochs_done;
+    //! Number of epochs to be integrated in this run
+    int n_epochs;
+
+public:
+    //! Constructor
+    SimDPRun(
+        std::shared_future<bool> result,
+        std::shared_ptr< std::atomic<int> > n_epochs_done,
+        const int n_epochs
+    );
+    //! Whether the run has finished
+    bool done() const;
+    //! Wait for the run to finish, and report whether it was successful
+    bool wait() const;
+    //! Fetch the number of epochs integrated so far in this run
+    int get_n_epochs_done() const;
+    //! Fetch the number of epochs to be integrated in this run
+    int get_n_epochs() const;
+};
 
 /**
  * @brief Class that manages simulation of DPLangevin equation.
@@ -17,6 +64,11 @@
  */
 class SimDP 
 {
+    //! An ensemble runs replicas directly and gathers their time series
+    friend class SimDPEnsemble;
+    //! A sweep sets up and integrates each run directly, and gathers its time series
+    friend class SimDPSweep;
+
 private:
     //! Langevin equation coefficients
     Coefficients coefficients;
@@ -24,10 +76,12 @@ private:
     Parameters p;
     //! Random number generation function (Mersenne prime) (pointer to RNG)
     rng_t *rng; 
-    //! Instance of DP Langevin integrator class (pointer to instance)
-    DPLangevin *dpLangevin;
+    //! Instance of DP Langevin integrator class, at the chosen precision (pointer to instance)
+    BaseLangevin *dpLangevin;
+    //! Pool of threads sharing the deterministic integration sweeps (pointer to pool)
+    ThreadPool *thread_pool;
     //! Integrator: either a Runge-Kutta or an Euler method
-    void (DPLangevin::*integrator)(rng_t&);
+    void (BaseLangevin::*integrator)(rng_t&);
     
     //! Total number of simulation time steps aka "epochs"
     int n_epochs;
@@ -39,38 +93,96 @@ private:
     double t_current_epoch;
     //! Time of next epoch
     double t_next_epoch;
-    //! Vector time-series of epochs
-    dbl_vec_t t_epochs;
-    //! Truncation number of decimal places when summing Δt
+    //! Vector time-series of epochs (shared with any Python views of it)
+    std::shared_ptr<dbl_vec_t> t_epochs;
+    //! Rounding number of decimal places of epoch times
     int n_decimals;
-    //! Vector time-series of grid-averaged field density values
-    dbl_vec_t mean_densities;
-    //! Python-compatible array of epochs time-series
+    //! Scale factor 10^n_decimals used to round epoch times
+    double decimals_scale = 1;
+    //! Vector time-series of grid-averaged field density values (shared with any Python views of it)
+    std::shared_ptr<dbl_vec_t> mean_densities;
+    //! Python-compatible read-only view of epochs time-series
     py_array_t pyarray_t_epochs;
-    //! Python-compatible array of mean density time-series
+    //! Python-compatible read-only view of mean density time-series
     py_array_t pyarray_mean_densities;
-    //! Python-compatible array of current density grid
-    py_array_t pyarray_density;
+    //! Observables measured at every epoch, alongside the mean density
+    obs_vec_t observables;
+    //! Vector time-series of each observable (shared with any Python views of them)
+    std::vector< std::shared_ptr<dbl_vec_t> > observable_series;
+    //! Python-compatible read-only views of the observable time-series
+    std::vector<py_array_t> pyarray_observables;
+    //! Number of epochs between recorded frames of the density grid (0: no recording)
+    int n_epochs_per_frame = 0;
+    //! Subsampling stride in x and y of recorded frames
+    int frame_stride = 1;
+    //! Number of frames in the recording
+    int n_frames = 0;
+    //! Frame shape: number of rows (y) and columns (x)
+    int n_frame_y = 0, n_frame_x = 0;
+    //! Recorded frames of the density grid, preallocated (shared with any Python views of it)
+    std::shared_ptr<dbl_vec_t> frames;
+    //! Python-compatible read-only view of the recorded frames
+    py_array_t pyarray_frames;
+    //! Output stream of the time series and (optionally) frames to disk
+    SimDPStream stream;
+    //! Number of epochs between streamed frames of the density grid (0: no frames)
+    int n_epochs_per_stream_frame = 0;
+    //! Subsampling stride in x and y of streamed frames
+    int stream_stride = 1;
+    //! Flag whether the time step is adapted epoch by epoch, up to p.dt, rather than fixed at p.dt
+    bool is_adaptive = false;
+    //! Tolerance of the scaled local error estimate of adaptive steps
+    double error_tolerance = 0;
+    //! Smallest time step adaptive steps may take
+    double dt_min = 0;
+    //! Time step chosen for the next adaptive step (which may be cut short to end at t_final)
+    double dt_next = 0;
     //! Flag whether integration step was successful or not
     bool did_integrate = false;
     //! Flag whether simulation has been initialized or not
     bool is_initialized = false;
     //! Flag whether to report sim state at all
     bool do_verbose = false;
+    //! Result of the latest background run, if any
+    std::shared_future<bool> async_result;
 
-    //! Count upcoming number of epochs by running a dummy time-stepping loop
+    //! Compute the time of the epoch following one at `t_epoch`
+    double next_epoch_time(const double t_epoch) const;
+    //! Count upcoming number of epochs needed to reach t_final
     int count_epochs() const;
     //! Chooses function implementing either Runge-Kutta or Euler integration methods
     bool choose_integrator();
-    //! Perform Dornic-type integration of the DP Langevin equation for `n_next_epochs`
-    bool integrate(const int n_next_epochs);
+    //! Round an adaptive time step down onto the ladder of permitted steps
+    double choose_dt(const double dt_target) const;
+    //! Choose the time step of the next adaptive step from the error and stability of the latest
+    void adapt_dt();
+    //! Enlarge the time series (and frames) of adaptive runs to hold epoch `i_epoch`
+    void grow_series(const int i_epoch);
+    //! Perform Dornic-type integration of the DP Langevin equation for `n_next_epochs`, counting them off in `n_epochs_done` if given
+    bool integrate(
+        const int n_next_epochs, std::atomic<int>* n_epochs_done = nullptr
+    );
+    //! Record the observables, if any, of epoch `i_epoch`
+    void record_observables(const int i_epoch);
+    //! Copy the density grid into its frame if the epoch `i_epoch` is to be recorded
+    void record_frame(const int i_epoch);
+    //! Hand the time-series record, and frame if due, of epoch `i_epoch` to the output stream if open
+    void stream_epoch(const int i_epoch);
+    //! Fill a checkpoint header with the simulation parameters and current state
+    CheckpointHeader checkpoint_header() const;
+    //! Whether a background run is still in progress, in which case report that `method` can't proceed
+    bool is_busy(const char* method) const;
 
-    //! Generate a Python-compatible version of the epochs time-series vector
+    //! Generate a Python-compatible view of the epochs time-series vector
     bool pyprep_t_epochs();
-    //! Generate a Python-compatible version of the mean densities time-series vector
+    //! Generate a Python-compatible view of the mean densities time-series vector
     bool pyprep_mean_densities();
-    //! Generate a Python-compatible version of the current density grid
-    bool pyprep_density_grid();
+    //! Generate a Python-compatible copy, or read-only view, of the current density grid
+    py::array pyarray_density_grid(const bool is_view) const;
+    //! Generate Python-compatible views of the observables time-series vectors
+    bool pyprep_observables();
+    //! Generate a Python-compatible view of the recorded frames of the density grid
+    bool pyprep_frames();
 
 public:
     //! Constructor
@@ -88,12 +200,38 @@ public:
         const InitialCondition initial_condition,
         const dbl_vec_t ic_values,
         const IntegrationMethod integration_method,
-        const bool do_verbose
+        const bool do_verbose,
+        const RandomGenerator random_generator,
+        const Precision precision,
+        const int n_threads
     );
+    //! Destructor
+    ~SimDP();
+    SimDP(const SimDP&) = delete;
+    SimDP& operator=(const SimDP&) = delete;
     //! Initialize the model simulation
     bool initialize(int n_decimals);
     //! Execute the model simulation for `n_next_epochs`
     bool run(const int n_next_epochs);
+    //! Start executing the model simulation for `n_next_epochs` in a background thread
+    SimDPRun run_async(const int n_next_epochs);
+    //! Measure `observables` at every epoch during subsequent runs
+    bool set_observables(const obs_vec_t& observables);
+    //! Record the density grid every `n_epochs_per_frame` epochs, subsampled by `stride`, during subsequent runs
+    bool set_frame_recorder(const int n_epochs_per_frame, const int stride);
+    //! Adapt the time step epoch by epoch to keep local error estimates within `error_tolerance`, during subsequent runs
+    bool set_adaptive_dt(const double error_tolerance, const double dt_min);
+    //! Stream the time series, and frames every `n_epochs_per_frame` epochs, to files at `path_stem` during subsequent runs
+    bool open_stream(
+        const std::string& path_stem, 
+        const int n_epochs_per_frame, const int stride
+    );
+    //! Finish writing the output stream and close its files
+    bool close_stream();
+    //! Save the full simulation state to a binary checkpoint file
+    bool save_checkpoint(const std::string& path);
+    //! Restore the full simulation state from a binary checkpoint file
+    bool load_checkpoint(const std::string& path);
     //! Process the model results data if available
     bool postprocess();
 
@@ -113,8 +251,14 @@ public:
     py_array_t get_t_epochs() const;
     //! Fetch a times-series vector of the grid-averaged density field over time as a Python array
     py_array_t get_mean_densities() const;
-    //! Fetch the current Langevin density field grid as a Python array
-    py_array_t get_density() const;
+    //! Fetch a times-series vector of an observable over time as a Python array
+    py_array_t get_observable(const Observable observable) const;
+    //! Fetch a snapshot copy of the current Langevin density field grid as a (float64) Python array
+    py::array get_density() const;
+    //! Fetch a read-only view of the current Langevin density field grid, at grid precision, as a Python array
+    py::array get_density_view() const;
+    //! Fetch the recorded frames of the density grid as a (n_frames, n_y, n_x) Python array
+    py_array_t get_frames() const;
 };
 
 
@@ -0,0 +1,268 @@
+/**
+ * @file sim_dplangevin_checkpoint.cpp
+ * @brief Methods to save and restore the full state of a DP Langevin simulation.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include "sim_dplangevin.hpp"
+
+//! Round a byte offset up to the next section boundary
+static std::uint64_t align_offset(const std::uint64_t offset)
+{
+    return (
+        (offset+checkpoint_alignment-1)/checkpoint_alignment
+    )*checkpoint_alignment;
+}
+
+//! Write zero bytes up to the given offset of `file`
+static bool pad_to(std::FILE* file, const std::uint64_t offset)
+{
+    const auto position = std::ftell(file);
+    if (position<0) { return false; }
+    for (auto i=static_cast<std::uint64_t>(position); i<offset; i++)
+    {
+        if (std::fputc(0, file)==EOF) { return false; }
+    }
+    return true;
+}
+
+//! Fill in the parameters and state of this simulation; the section
+//! offsets and sizes are left for the caller
+CheckpointHeader SimDP::checkpoint_header() const
+{
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, checkpoint_magic, sizeof(header.magic));
+    header.byte_order_mark = 0x0102030405060708ULL;
+    header.version = checkpoint_version;
+    header.header_size = sizeof(CheckpointHeader);
+
+    header.grid_dimension = static_cast<std::int64_t>(p.grid_dimension);
+    header.n_x = p.n_x;
+    header.n_y = p.n_y;
+    header.n_z = p.n_z;
+    header.n_cells = p.n_cells;
+    for (size_t i=0; i<p.grid_topologies.size() and i<3; i++)
+    {
+        header.grid_topologies[i]
+            = static_cast<std::int64_t>(p.grid_topologies[i]);
+    }
+    for (size_t i=0; i<p.boundary_conditions.size() and i<6; i++)
+    {
+        header.boundary_conditions[i]
+            = static_cast<std::int64_t>(p.boundary_conditions[i]);
+    }
+    for (size_t i=0; i<p.bc_values.size() and i<6; i++)
+    {
+        header.bc_values[i] = p.bc_values[i];
+    }
+    header.integration_method
+        = static_cast<std::int64_t>(p.integration_method);
+    header.random_generator = static_cast<std::int64_t>(p.random_generator);
+    header.precision = static_cast<std::int64_t>(p.precision);
+    header.random_seed = p.random_seed;
+    header.linear = coefficients.linear;
+    header.quadratic = coefficients.quadratic;
+    header.diffusion = coefficients.diffusion;
+    header.noise = coefficients.noise;
+    header.t_final = p.t_final;
+    header.dx = p.dx;
+    header.dt = p.dt;
+    header.n_decimals = n_decimals;
+    header.n_epochs = n_epochs;
+
+    header.i_current_epoch = i_current_epoch;
+    header.i_next_epoch = i_next_epoch;
+    header.t_current_epoch = t_current_epoch;
+    header.t_next_epoch = t_next_epoch;
+    header.i_step = dpLangevin->get_i_step();
+    header.mean_density = dpLangevin->get_mean_density();
+    return header;
+}
+
+/**
+ * @details Save everything needed to resume this simulation exactly where
+ * it is: the density grid, the epoch counters and time series,
+ * the step count, and the rng state (see CheckpointHeader for the layout).
+ * The file is written under a temporary name and then renamed to `path`,
+ * so an interrupted save never leaves a partial checkpoint behind.
+ * Frame recording and output streaming settings are not saved.
+ */
+bool SimDP::save_checkpoint(const std::string& path)
+{
+    if (not is_initialized)
+    {
+        std::cout << "SimDP::save_checkpoint failure: must initialize first" << std::endl;
+        return false;
+    }
+    if (is_busy("save_checkpoint")) { return false; }
+    if (is_adaptive)
+    {
+        std::cout << "SimDP::save_checkpoint failure: not possible with adaptive time steps" << std::endl;
+        return false;
+    }
+    std::ostringstream rng_state;
+    rng_state << *rng;
+    const auto rng_text = rng_state.str();
+
+    auto header = checkpoint_header();
+    const std::uint64_t real_size
+        = (p.precision==Precision::FLOAT32) ? sizeof(float) : sizeof(double);
+    header.grid_offset = align_offset(sizeof(CheckpointHeader));
+    header.grid_n_bytes = real_size*p.n_cells;
+    header.series_n_bytes = sizeof(double)*n_epochs;
+    header.t_epochs_offset
+        = align_offset(header.grid_offset+header.grid_n_bytes);
+    header.mean_densities_offset
+        = align_offset(header.t_epochs_offset+header.series_n_bytes);
+    header.rng_offset
+        = align_offset(header.mean_densities_offset+header.series_n_bytes);
+    header.rng_n_bytes = rng_text.size();
+
+    const auto temporary_path = path + ".tmp";
+    auto file = std::fopen(temporary_path.c_str(), "wb");
+    if (not file)
+    {
+        std::cout << "SimDP::save_checkpoint failure: couldn't create file" << std::endl;
+        return false;
+    }
+    auto did_save = (
+        std::fwrite(&header, sizeof(header), 1, file)==1
+        and pad_to(file, header.grid_offset)
+        and dpLangevin->write_density_grid(file)
+        and pad_to(file, header.t_epochs_offset)
+        and std::fwrite(t_epochs->data(), sizeof(double), n_epochs, file)
+            ==static_cast<size_t>(n_epochs)
+        and pad_to(file, header.mean_densities_offset)
+        and std::fwrite(mean_densities->data(), sizeof(double), n_epochs, file)
+            ==static_cast<size_t>(n_epochs)
+        and pad_to(file, header.rng_offset)
+        and std::fwrite(rng_text.data(), 1, rng_text.size(), file)
+            ==rng_text.size()
+    );
+    did_save = (std::fclose(file)==0 and did_save);
+    did_save = (
+        did_save and std::rename(temporary_path.c_str(), path.c_str())==0
+    );
+    if (not did_save)
+    {
+        std::remove(temporary_path.c_str());
+        std::cout << "SimDP::save_checkpoint failure: couldn't write file" << std::endl;
+    }
+    return did_save;
+}
+
+/**
+ * @details Resume a simulation from a checkpoint written by
+ * `save_checkpoint`: this simulation must have been constructed and
+ * initialized with exactly the same parameters (and `n_decimals`),
+ * else the checkpoint is refused. Subsequent runs then reproduce those
+ * of the original simulation bit for bit.
+ */
+bool SimDP::load_checkpoint(const std::string& path)
+{
+    if (not is_initialized)
+    {
+        std::cout << "SimDP::load_checkpoint failure: must initialize first" << std::endl;
+        return false;
+    }
+    if (is_busy("load_checkpoint")) { return false; }
+    if (is_adaptive)
+    {
+        std::cout << "SimDP::load_checkpoint failure: not possible with adaptive time steps" << std::endl;
+        return false;
+    }
+    auto file = std::fopen(path.c_str(), "rb");
+    if (not file)
+    {
+        std::cout << "SimDP::load_checkpoint failure: couldn't open file" << std::endl;
+        return false;
+    }
+    auto fail = [&](const char* reason) -> bool
+    {
+        std::fclose(file);
+        std::cout << "SimDP::load_checkpoint failure: " << reason << std::endl;
+        return false;
+    };
+
+    CheckpointHeader header;
+    if (std::fread(&header, sizeof(header), 1, file)!=1)
+    {
+        return fail("file too short");
+    }
+    const auto expected = checkpoint_header();
+    if (
+        std::memcmp(header.magic, expected.magic, sizeof(header.magic))!=0
+        or header.byte_order_mark!=expected.byte_order_mark
+        or header.version!=expected.version
+        or header.header_size!=expected.header_size
+    )
+    {
+        return fail("not a checkpoint file of this version and byte order");
+    }
+    // Parameter fields run from grid_dimension up to the state fields
+    const auto i_parameters = offsetof(CheckpointHeader, grid_dimension);
+    const auto n_parameter_bytes
+        = offsetof(CheckpointHeader, i_current_epoch) - i_parameters;
+    if (
+        std::memcmp(
+            reinterpret_cast<const char*>(&header) + i_parameters,
+            reinterpret_cast<const char*>(&expected) + i_parameters,
+            n_parameter_bytes
+        )!=0
+    )
+    {
+        return fail("simulation parameters differ from the checkpoint's");
+    }
+
+    // Read everything but the grid first, so a bad file changes nothing
+    dbl_vec_t saved_t_epochs(n_epochs), saved_mean_densities(n_epochs);
+    std::string rng_text(header.rng_n_bytes, '\0');
+    if (
+        std::fseek(file, header.t_epochs_offset, SEEK_SET)!=0
+        or std::fread(saved_t_epochs.data(), sizeof(double), n_epochs, file)
+            !=static_cast<size_t>(n_epochs)
+        or std::fseek(file, header.mean_densities_offset, SEEK_SET)!=0
+        or std::fread(saved_mean_densities.data(), sizeof(double), n_epochs, file)
+            !=static_cast<size_t>(n_epochs)
+        or std::fseek(file, header.rng_offset, SEEK_SET)!=0
+        or std::fread(&rng_text[0], 1, rng_text.size(), file)!=rng_text.size()
+    )
+    {
+        return fail("file truncated");
+    }
+    std::istringstream rng_state(rng_text);
+    rng_t saved_rng;
+    rng_state >> saved_rng;
+    if (rng_state.fail()) { return fail("bad rng state"); }
+
+    if (
+        std::fseek(file, header.grid_offset, SEEK_SET)!=0
+        or not dpLangevin->read_density_grid(file)
+    )
+    {
+        // The grid may be partly overwritten, so it can't be run on
+        is_initialized = false;
+        return fail("file truncated; simulation must be reinitialized");
+    }
+    std::fclose(file);
+
+    // Copy in place, so Python views of the time series stay current
+    std::copy(
+        saved_t_epochs.begin(), saved_t_epochs.end(), t_epochs->begin()
+    );
+    std::copy(
+        saved_mean_densities.begin(), saved_mean_densities.end(),
+        mean_densities->begin()
+    );
+    *rng = saved_rng;
+    i_current_epoch = header.i_current_epoch;
+    i_next_epoch = header.i_next_epoch;
+    t_current_epoch = header.t_current_epoch;
+    t_next_epoch = header.t_next_epoch;
+    dpLangevin->set_step_state(header.i_step, header.mean_density);
+    return true;
+}
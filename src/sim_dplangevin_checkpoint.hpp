@@ -0,0 +1,80 @@
+/**
+ * @file sim_dplangevin_checkpoint.hpp
+ * @brief Layout of the binary checkpoint files of DP Langevin simulations.
+ */
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <cstdint>
+
+/**
+ * @brief Header of a binary checkpoint file of a DP Langevin simulation.
+ *
+ * A checkpoint file is this header, followed by sections at the offsets
+ * given in it, each aligned to `checkpoint_alignment` bytes:
+ *   - the density grid: n_cells values at the grid precision
+ *     (float32 or float64), row by row with x varying fastest;
+ *   - the epochs time series: n_epochs float64 values;
+ *   - the mean density time series: n_epochs float64 values;
+ *   - the Mersenne Twister rng state, as text (its standard stream format).
+ *
+ * Every header field is 8 bytes wide, so the layout has no padding,
+ * and values are in the byte order of the machine that wrote them
+ * (checked on loading using `byte_order_mark`): so the file can be
+ * memory-mapped and its sections read in place, e.g., by `numpy.memmap`.
+ *
+ * The simulation parameters are recorded so that a checkpoint is only
+ * loaded into a simulation set up in exactly the same way.
+ */
+struct CheckpointHeader
+{
+    //! File type tag: "DPLVNCKP"
+    char magic[8];
+    //! 0x0102030405060708 in the byte order of the writing machine
+    std::uint64_t byte_order_mark;
+    //! Checkpoint format version
+    std::uint64_t version;
+    //! Size of this header in bytes
+    std::uint64_t header_size;
+
+    // Simulation parameters (which must match on loading)
+
+    std::int64_t grid_dimension;
+    std::int64_t n_x, n_y, n_z, n_cells;
+    std::int64_t grid_topologies[3];
+    std::int64_t boundary_conditions[6];
+    double bc_values[6];
+    std::int64_t integration_method;
+    std::int64_t random_generator;
+    std::int64_t precision;
+    std::int64_t random_seed;
+    double linear, quadratic, diffusion, noise;
+    double t_final, dx, dt;
+    std::int64_t n_decimals;
+    std::int64_t n_epochs;
+
+    // Simulation state
+
+    std::int64_t i_current_epoch, i_next_epoch;
+    double t_current_epoch, t_next_epoch;
+    //! Count of integration steps taken (keys Philox rng streams)
+    std::uint64_t i_step;
+    //! Grid-averaged density after the latest step
+    double mean_density;
+
+    // Sections
+
+    std::uint64_t grid_offset, grid_n_bytes;
+    std::uint64_t t_epochs_offset, mean_densities_offset, series_n_bytes;
+    std::uint64_t rng_offset, rng_n_bytes;
+};
+
+//! Tag at the start of every checkpoint file
+const char checkpoint_magic[8] = {'D','P','L','V','N','C','K','P'};
+//! Current checkpoint format version
+const std::uint64_t checkpoint_version = 1;
+//! Alignment in bytes of each section of a checkpoint file
+const std::uint64_t checkpoint_alignment = 64;
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file sim_dplangevin_ensemble.cpp
+ * @brief Methods of class that manages an ensemble of DP Langevin simulations.
+ */
+
+#include <algorithm>
+#include "sim_dplangevin_ensemble.hpp"
+
+/**
+ * @details Constructor for class that manages an ensemble of independent
+ * DP Langevin simulations: replica #i is seeded with `random_seed+i`,
+ * and otherwise has the same parameters as every other replica.
+ * There is always at least one replica.
+ */
+SimDPEnsemble::SimDPEnsemble(
+    const int n_replicas,
+    const double linear, const double quadratic,
+    const double diffusion, const double noise,
+    const double t_final,
+    const double dx, const double dt,
+    const int random_seed,
+    const GridDimension grid_dimension,
+    const int_vec_t grid_size,
+    const gt_vec_t grid_topologies,
+    const bc_vec_t boundary_conditions,
+    const dbl_vec_t bc_values,
+    const InitialCondition initial_condition,
+    const dbl_vec_t ic_values,
+    const IntegrationMethod integration_method,
+    const bool do_verbose,
+    const RandomGenerator random_generator,
+    const Precision precision,
+    const int n_threads
+) : n_replicas(std::max(n_replicas, 1))
+{
+    for (auto i_replica=0; i_replica<this->n_replicas; i_replica++)
+    {
+        // Each replica integrates in the thread it's handed to
+        replicas.push_back(new SimDP(
+            linear, quadratic, diffusion, noise,
+            t_final, dx, dt,
+            random_seed+i_replica,
+            grid_dimension, grid_size, grid_topologies,
+            boundary_conditions, bc_values,
+            initial_condition, ic_values,
+            integration_method, false,
+            random_generator, precision, 1
+        ));
+    }
+    thread_pool = new ThreadPool(n_threads);
+    if (do_verbose)
+    {
+        replicas[0]->coefficients.print();
+        replicas[0]->p.print();
+        std::cout << "n_replicas: " << this->n_replicas << std::endl;
+        std::cout << "n_threads: " << thread_pool->get_n_threads() << std::endl;
+    }
+}
+
+//! Destructor: release the replicas and thread pool
+SimDPEnsemble::~SimDPEnsemble()
+{
+    for (auto& replica : replicas) { delete replica; }
+    delete thread_pool;
+}
+
+//! Run `replica_task` on every replica, handing replicas out one at a time
+//! to the threads of the pool, and report whether every task succeeded
+bool SimDPEnsemble::for_each_replica(
+    const std::function<bool(SimDP&)>& replica_task
+)
+{
+    std::vector<unsigned char> did_succeed(n_replicas, 0);
+    thread_pool->parallel_for(
+        n_replicas,
+        [&](const int i_replica)
+        {
+            did_succeed[i_replica] = replica_task(*replicas[i_replica]);
+        }
+    );
+    return std::all_of(
+        did_succeed.begin(), did_succeed.end(),
+        [](const unsigned char is_ok) { return is_ok; }
+    );
+}
+
+//! Method to be called first to set up all the replica simulations
+//! (see `SimDP::initialize`)
+bool SimDPEnsemble::initialize(int n_decimals)
+{
+    is_initialized = for_each_replica(
+        [&](SimDP& replica) { return replica.initialize(n_decimals); }
+    );
+    return is_initialized;
+}
+
+//! Method to carry out a set of integration steps on every replica;
+//! can be rerun repeatedly, as with `SimDP::run`.
+//! No Python objects are touched here, so the wrapper lets other Python
+//! threads carry on while the ensemble runs.
+bool SimDPEnsemble::run(const int n_next_epochs)
+{
+    if (not is_initialized)
+    {
+        std::cout << "SimDPEnsemble::run failure: must initialize first" << std::endl;
+        return false;
+    }
+    return for_each_replica(
+        [&](SimDP& replica) { return replica.run(n_next_epochs); }
+    );
+}
+
+//! Choose the observables measured in every replica (see 
+//! `SimDP::set_observables`)
+bool SimDPEnsemble::set_observables(const obs_vec_t& observables)
+{
+    if (not is_initialized)
+    {
+        std::cout << "SimDPEnsemble::set_observables failure: must initialize first" << std::endl;
+        return false;
+    }
+    this->observables = observables;
+    return for_each_replica(
+        [&](SimDP& replica) { return replica.set_observables(observables); }
+    );
+}
+
+//! Method to be called after each `run`: the epochs, mean-density and
+//! observable time series of all the replicas are packed and made 
+//! available to Python
+bool SimDPEnsemble::postprocess()
+{
+    if (not is_initialized)
+    {
+        std::cout << "SimDPEnsemble::postprocess failure: no data to process yet" << std::endl;
+        return false;
+    }
+    bool did_process = (
+        replicas[0]->pyprep_t_epochs() and pyprep_mean_densities()
+        and pyprep_observables()
+    );
+    pyarray_t_epochs = replicas[0]->pyarray_t_epochs;
+    return did_process;
+}
+
+//! Stack the replicas' time series picked out by `series` into one array 
+//! of shape (n_replicas, n_epochs)
+py_array_t SimDPEnsemble::stack_series(
+    const std::function<const dbl_vec_t&(const SimDP&)>& series
+) const
+{
+    const auto n_epochs = get_n_epochs();
+    py_array_t series_array({n_replicas, n_epochs});
+    auto series_proxy = series_array.mutable_unchecked();
+    for (auto i_replica=0; i_replica<n_replicas; i_replica++)
+    {
+        const auto& replica_series = series(*replicas[i_replica]);
+        for (auto i=0; i<n_epochs; i++)
+        {
+            series_proxy(i_replica, i) = replica_series[i];
+        }
+    }
+    return series_array;
+}
+
+bool SimDPEnsemble::pyprep_mean_densities()
+{
+    pyarray_mean_densities = stack_series(
+        [](const SimDP& replica) -> const dbl_vec_t& 
+            { return *replica.mean_densities; }
+    );
+    return true;
+}
+
+bool SimDPEnsemble::pyprep_observables()
+{
+    pyarray_observables.clear();
+    for (size_t i_observable=0; i_observable<observables.size(); i_observable++)
+    {
+        pyarray_observables.push_back(stack_series(
+            [&](const SimDP& replica) -> const dbl_vec_t& 
+                { return *replica.observable_series[i_observable]; }
+        ));
+    }
+    return true;
+}
+
+int SimDPEnsemble::get_n_replicas() const { return n_replicas; }
+int SimDPEnsemble::get_n_epochs() const { return replicas[0]->get_n_epochs(); }
+int SimDPEnsemble::get_i_current_epoch() const
+    { return replicas[0]->get_i_current_epoch(); }
+double SimDPEnsemble::get_t_current_epoch() const
+    { return replicas[0]->get_t_current_epoch(); }
+py_array_t SimDPEnsemble::get_t_epochs() const { return pyarray_t_epochs; }
+py_array_t SimDPEnsemble::get_mean_densities() const
+    { return pyarray_mean_densities; }
+py_array_t SimDPEnsemble::get_observable(const Observable observable) const
+{
+    for (size_t i=0; i<observables.size() and i<pyarray_observables.size(); i++)
+    {
+        if (observables[i]==observable) { return pyarray_observables[i]; }
+    }
+    std::cout << "SimDPEnsemble::get_observable failure: not measured or not postprocessed" << std::endl;
+    return py_array_t();
+}
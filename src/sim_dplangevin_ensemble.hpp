@@ -0,0 +1,109 @@
+/**
+ * @file sim_dplangevin_ensemble.hpp
+ * @brief Class that manages an ensemble of independent DP Langevin simulations.
+ */
+
+#ifndef SIMDPENSEMBLE_HPP
+#define SIMDPENSEMBLE_HPP
+
+#include "sim_dplangevin.hpp"
+
+/**
+ * @brief Class that manages an ensemble of independent DP Langevin simulations.
+ *
+ * Holds `n_replicas` SimDP instances with identical parameters except for
+ * their random seeds, which run `random_seed`, `random_seed+1`, ...
+ * Each replica is integrated in a single thread, and the replicas
+ * are shared across a pool of `n_threads` threads: so a whole ensemble
+ * of (small-grid) simulations runs in one call from Python, rather than
+ * one replica at a time. The replicas' grids all share one cell wiring
+ * (see GridWiringCache).
+ *
+ * Replicas are independent, so each one's results are the same as those of
+ * a lone SimDP simulation with the same seed, whatever the number of threads.
+ */
+class SimDPEnsemble
+{
+private:
+    //! Number of replica simulations
+    int n_replicas;
+    //! Replica simulations (pointers to instances)
+    std::vector<SimDP*> replicas;
+    //! Pool of threads sharing the replica simulations (pointer to pool)
+    ThreadPool *thread_pool;
+    //! Python-compatible array of epochs time-series
+    py_array_t pyarray_t_epochs;
+    //! Python-compatible array of mean density time-series, one row per replica
+    py_array_t pyarray_mean_densities;
+    //! Observables measured by every replica
+    obs_vec_t observables;
+    //! Python-compatible arrays of observable time-series, one row per replica
+    std::vector<py_array_t> pyarray_observables;
+    //! Flag whether all replicas have been initialized or not
+    bool is_initialized = false;
+
+    //! Apply `replica_task(replica)` to every replica across the thread pool, and report whether all succeeded
+    bool for_each_replica(const std::function<bool(SimDP&)>& replica_task);
+    //! Stack a time series of every replica into a Python-compatible array, one row per replica
+    py_array_t stack_series(
+        const std::function<const dbl_vec_t&(const SimDP&)>& series
+    ) const;
+    //! Generate a Python-compatible array of mean densities time-series, one row per replica
+    bool pyprep_mean_densities();
+    //! Generate Python-compatible arrays of observables time-series, one row per replica
+    bool pyprep_observables();
+
+public:
+    //! Constructor
+    SimDPEnsemble(
+        const int n_replicas,
+        const double linear, const double quadratic,
+        const double diffusion, const double noise,
+        const double t_final,
+        const double dx, const double dt,
+        const int random_seed,
+        const GridDimension grid_dimension,
+        const int_vec_t grid_size,
+        const gt_vec_t grid_topologies,
+        const bc_vec_t boundary_conditions,
+        const dbl_vec_t bc_values,
+        const InitialCondition initial_condition,
+        const dbl_vec_t ic_values,
+        const IntegrationMethod integration_method,
+        const bool do_verbose,
+        const RandomGenerator random_generator,
+        const Precision precision,
+        const int n_threads
+    );
+    //! Destructor
+    ~SimDPEnsemble();
+    SimDPEnsemble(const SimDPEnsemble&) = delete;
+    SimDPEnsemble& operator=(const SimDPEnsemble&) = delete;
+    //! Initialize all the replica simulations
+    bool initialize(int n_decimals);
+    //! Execute all the replica simulations for `n_next_epochs`
+    bool run(const int n_next_epochs);
+    //! Measure `observables` at every epoch in every replica during subsequent runs
+    bool set_observables(const obs_vec_t& observables);
+    //! Process the ensemble results data if available
+    bool postprocess();
+
+    // Utilities provided to Python via the wrapper
+
+    //! Fetch the number of replica simulations
+    int get_n_replicas() const;
+    //! Fetch the total number of simulation epochs
+    int get_n_epochs() const;
+    //! Fetch the index of the current epoch of the simulations
+    int get_i_current_epoch() const;
+    //! Fetch the current epoch (time) of the simulations
+    double get_t_current_epoch() const;
+    //! Fetch a times-series vector of the simulation epochs as a Python array
+    py_array_t get_t_epochs() const;
+    //! Fetch the grid-averaged density time series of all replicas as a 2D Python array
+    py_array_t get_mean_densities() const;
+    //! Fetch an observable's time series of all replicas as a 2D Python array
+    py_array_t get_observable(const Observable observable) const;
+};
+
+#endif
@@ -3,14 +3,16 @@
  * @brief Class to manage & run DPLangevin model simulation: private methods.
  */ 
 
+#include <algorithm>
 #include "sim_dplangevin.hpp"
 
-double round(const double value, const int n_decimals) {
-    const double multiplier = std::pow(10, n_decimals);
-    return std::round(value * multiplier) / multiplier;
+//! Time of the epoch after one at time `t_epoch`: epoch times are 
+//! accumulated step by step, each rounded to n_decimals places
+double SimDP::next_epoch_time(const double t_epoch) const
+{
+    return std::round((t_epoch+p.dt)*decimals_scale) / decimals_scale;
 }
 
-
 //! Count total number of time steps, just in case rounding causes problems
 int SimDP::count_epochs() const
 {
@@ -19,33 +21,103 @@ int SimDP::count_epochs() const
     for (
         n_epochs=0, t=0; 
         t<p.t_final; 
-        t=round(t+p.dt, n_decimals), n_epochs++
+        t=next_epoch_time(t), n_epochs++
     ) {}
     return n_epochs+1;
 }
 
+//! Longest step Δt_max·2^(-k/4), for k=0,1,2..., no longer than `dt_target`
+//! (but no shorter than dt_min), where Δt_max is the Δt of the model 
+//! parameters: so adaptive runs take only a few distinct steps, whose
+//! Dornic coefficients are computed once and cached
+double SimDP::choose_dt(const double dt_target) const
+{
+    const auto k_max = static_cast<int>(std::floor(4*std::log2(p.dt/dt_min)));
+    const auto k = static_cast<int>(
+        std::ceil(4*std::log2(p.dt/dt_target) - 1e-9)
+    );
+    return p.dt*std::exp2(-std::min(std::max(k, 0), k_max)/4.0);
+}
+
+//! Choose the next adaptive step from the error estimate ε of the step just
+//! taken, of first order (so scaling as Δt²): Δt·0.9(tolerance/ε)^½, 
+//! changed by at most a factor of two either way, and within the stability
+//! limit of explicit Runge-Kutta
+void SimDP::adapt_dt()
+{
+    const auto error = dpLangevin->get_step_error();
+    const auto factor = (error>0) 
+        ? std::min(std::max(0.9*std::sqrt(error_tolerance/error), 0.5), 2.0)
+        : 2.0;
+    auto dt_target = dpLangevin->get_dt()*factor;
+    const auto stiffness = dpLangevin->get_stiffness();
+    if (stiffness>0) 
+    { 
+        dt_target = std::min(dt_target, rk4_stability_limit/stiffness); 
+    }
+    dt_next = choose_dt(dt_target);
+}
+
+//! Make room for epoch `i_epoch` in the time series (and frames, if 
+//! recording) of an adaptive run, doubling their length: into fresh
+//! buffers, so Python views of the old ones stay valid
+void SimDP::grow_series(const int i_epoch)
+{
+    const auto n_allotted = t_epochs->size();
+    if (static_cast<size_t>(i_epoch)<n_allotted) { return; }
+    const auto n_epochs_allotted = std::max(
+        2*n_allotted, static_cast<size_t>(i_epoch)+1
+    );
+    auto grow = [](std::shared_ptr<dbl_vec_t>& series, const size_t size)
+    {
+        auto grown = std::make_shared<dbl_vec_t>(*series);
+        grown->resize(size, 0.0);
+        series = grown;
+    };
+    grow(t_epochs, n_epochs_allotted);
+    grow(mean_densities, n_epochs_allotted);
+    for (auto& series : observable_series) { grow(series, n_epochs_allotted); }
+    if (n_epochs_per_frame>0)
+    {
+        grow(
+            frames, 
+            ((n_epochs_allotted-1)/n_epochs_per_frame + 1)
+                *static_cast<size_t>(n_frame_y)*n_frame_x
+        );
+    }
+}
+
 bool SimDP::choose_integrator()
 {
     switch (p.integration_method)
     {
         case (IntegrationMethod::RUNGE_KUTTA):
-            integrator = &DPLangevin::integrate_rungekutta;
+            integrator = &BaseLangevin::integrate_rungekutta;
+            return true;
+        case (IntegrationMethod::RUNGE_KUTTA_BLOCKED):
+            integrator = &BaseLangevin::integrate_rungekutta_blocked;
             return true;
         case (IntegrationMethod::EULER):
-            integrator = &DPLangevin::integrate_euler;
+            integrator = &BaseLangevin::integrate_euler;
+            return true;
+        case (IntegrationMethod::IMPLICIT_DIFFUSION):
+            integrator = &BaseLangevin::integrate_implicit;
             return true;
         default:
             return false;
     }
 }
 
-bool SimDP::integrate(const int n_next_epochs)
+bool SimDP::integrate(
+    const int n_next_epochs, std::atomic<int>* n_epochs_done
+)
 {
     // Check a further n_next_epochs won't exceed total permitted steps
-    if (t_epochs.size() < i_next_epoch+n_next_epochs)
+    // (adaptive runs enlarge their time series as they go)
+    if (not is_adaptive and t_epochs->size() < i_next_epoch+n_next_epochs)
     {
         std::cout << "Too many epochs: " 
-            << t_epochs.size() 
+            << t_epochs->size() 
             << " < " 
             << i_next_epoch+n_next_epochs 
             << std::endl;
@@ -54,11 +126,16 @@ bool SimDP::integrate(const int n_next_epochs)
     
     // Perform (possibly another another) n_next_epochs integration steps
     int i;
-    double t; 
+    double t;
     // For the very first epoch, record mean density right now
     if (i_next_epoch==1) { 
-        dpLangevin->apply_boundary_conditions(p, 0);
-        mean_densities[0] = dpLangevin->get_mean_density(); 
+        dpLangevin->apply_boundary_conditions(0);
+        (*mean_densities)[0] = dpLangevin->get_mean_density(); 
+        // Measure the initial grid, boundary cells included
+        if (not observables.empty()) { dpLangevin->find_occupied_blocks(); }
+        record_observables(0);
+        record_frame(0);
+        stream_epoch(0);
         i_current_epoch = 0;
         t_current_epoch = 0;
     }
@@ -66,68 +143,218 @@ bool SimDP::integrate(const int n_next_epochs)
     // Effectively increment epoch counter and add to Δt to time counter
     // so that both point the state *after* each integration step is complete.
     // In so doing, we will record t_epochs.size() + 1 total integration steps.
-    for (
-        i=i_next_epoch, t=t_next_epoch; 
-        i<i_next_epoch+n_next_epochs; 
-        t=round(t+p.dt, n_decimals), i++
-    )
+    for (i=i_next_epoch; i<i_next_epoch+n_next_epochs; i++)
     {
-        // Reapply boundary conditions prior to integrating
-        dpLangevin->apply_boundary_conditions(p, i);
-        // Perform a single integration over Δt
-        (dpLangevin->*integrator)(*rng);
+        if (is_adaptive)
+        {
+            // Adaptive steps stop at t_final, the last being cut short
+            const auto t_remaining = p.t_final - t_current_epoch;
+            if (t_remaining<=1e-9*p.dt) { break; }
+            const auto dt_step = std::min(dt_next, t_remaining);
+            // Fluxes at the grid edges were added over the previous Δt
+            if (i>1) { dpLangevin->rescale_boundary_fluxes(dt_step); }
+            dpLangevin->set_dt(dt_step);
+            t = t_current_epoch + dpLangevin->get_dt();
+            grow_series(i);
+        }
+        else 
+        { 
+            t = t_next_epoch; 
+            t_next_epoch = next_epoch_time(t);
+        }
+        // Boundary conditions must be applied prior to integrating: each
+        // step applies those of the next epoch within its final sweep,
+        // so only those of epoch#1 need a pass of their own
+        if (i==1) { dpLangevin->apply_boundary_conditions(i); }
+        // Perform a single integration over Δt, unless the grid (boundary 
+        // cells included) is entirely empty: then it's absorbed and stays so
+        if (not dpLangevin->is_absorbed()) 
+        { 
+            (dpLangevin->*integrator)(*rng); 
+            if (is_adaptive) { adapt_dt(); }
+        }
+        else { dpLangevin->apply_boundary_conditions(i+1); }
         // Record this epoch
-        t_epochs[i] = t;
-        mean_densities[i] = dpLangevin->get_mean_density();
+        (*t_epochs)[i] = t;
+        (*mean_densities)[i] = dpLangevin->get_mean_density();
+        record_observables(i);
+        record_frame(i);
+        stream_epoch(i);
         i_current_epoch = i;
         t_current_epoch = t;
+        if (n_epochs_done) { n_epochs_done->store(i-i_next_epoch+1); }
     };
     // Set epoch and time counters to point to *after* the last integration step
     i_next_epoch = i;
-    t_next_epoch = t;
+    if (is_adaptive)
+    {
+        // Only the epochs integrated so far are counted, and so viewable
+        n_epochs = i;
+        if (n_epochs_per_frame>0) 
+        { 
+            n_frames = (n_epochs-1)/n_epochs_per_frame + 1; 
+        }
+        t_next_epoch = std::min(t_current_epoch + dt_next, p.t_final);
+    }
     return true;
 }
 
-bool SimDP::pyprep_t_epochs()
+//! Compute each observable from the moments gathered during the latest 
+//! step, and record it for epoch `i_epoch`
+void SimDP::record_observables(const int i_epoch)
+{
+    for (size_t i=0; i<observables.size(); i++)
+    {
+        (*observable_series[i])[i_epoch] 
+            = dpLangevin->get_observable(observables[i]);
+    }
+}
+
+//! Copy the density grid into the frame for epoch `i_epoch`, if recording
+//! is on and this epoch falls on a frame
+void SimDP::record_frame(const int i_epoch)
+{
+    if (n_epochs_per_frame==0 or i_epoch%n_epochs_per_frame!=0) { return; }
+    const auto n_frame_cells = static_cast<size_t>(n_frame_y)*n_frame_x;
+    dpLangevin->copy_density_grid(
+        frame_stride, 
+        frames->data() + (i_epoch/n_epochs_per_frame)*n_frame_cells
+    );
+}
+
+//! Hand the time and mean density of epoch `i_epoch`, and the density grid
+//! if a frame is due, to the output stream, if it's open
+void SimDP::stream_epoch(const int i_epoch)
+{
+    if (not stream.is_open()) { return; }
+    const auto t = (*t_epochs)[i_epoch];
+    stream.write_epoch(i_epoch, t, (*mean_densities)[i_epoch]);
+    if (
+        n_epochs_per_stream_frame>0 
+        and i_epoch%n_epochs_per_stream_frame==0
+    )
+    {
+        dpLangevin->copy_density_grid(
+            stream_stride, stream.begin_frame(i_epoch, t)
+        );
+        stream.end_frame();
+    }
+}
+
+//! Check whether a background run started by `run_async` is still going:
+//! if so, `method` must not touch the simulation state, so say so
+bool SimDP::is_busy(const char* method) const
 {
-    py_array_t epochs_array(n_epochs);
-    auto epochs_proxy = epochs_array.mutable_unchecked();
-    for (auto i=0; i<n_epochs; i++)
+    if (
+        async_result.valid() 
+        and async_result.wait_for(std::chrono::seconds(0))
+            !=std::future_status::ready
+    )
     {
-        epochs_proxy(i) = t_epochs[i];
+        std::cout << "SimDP::" << method 
+            << " failure: background run still in progress" << std::endl;
+        return true;
+    }
+    return false;
+}
+
+//! Read-only NumPy view, of given shape, of a buffer that the view shares 
+//! ownership of: so it stays valid even if the simulation is reinitialized
+//! or deleted
+py_array_t pyview_buffer(
+    const std::shared_ptr<dbl_vec_t>& buffer, 
+    const std::vector<py::ssize_t>& shape
+)
+{
+    py::capsule owner(
+        new std::shared_ptr<dbl_vec_t>(buffer),
+        [](void* owner) { delete static_cast<std::shared_ptr<dbl_vec_t>*>(owner); }
+    );
+    py_array_t view(shape, buffer->data(), owner);
+    view.attr("setflags")(false);
+    return view;
+}
+
+//! NumPy array of a density grid, indexed as [x,y] (or [x,y,z] for a 3D 
+//! grid): either a float64 copy of the grid, or a read-only view of it,
+//! at grid precision, of the buffer holding the grid right now
+template<typename real_t>
+py::array pyarray_grid(
+    const std::vector<real_t>& grid, const Parameters& p, const bool is_view
+)
+{
+    std::vector<py::ssize_t> shape = {p.n_x, p.n_y};
+    std::vector<py::ssize_t> strides = {
+        static_cast<py::ssize_t>(sizeof(real_t)), 
+        static_cast<py::ssize_t>(p.n_x*sizeof(real_t))
     };
-    pyarray_t_epochs = epochs_array;
+    if (p.grid_dimension==GridDimension::D3)
+    {
+        shape.push_back(p.n_z);
+        strides.push_back(static_cast<py::ssize_t>(p.n_x*p.n_y*sizeof(real_t)));
+    }
+    if (not is_view)
+    {
+        // An array given no base is made as a copy of the grid
+        const py::array copy(py::dtype::of<real_t>(), shape, strides, grid.data());
+        return copy.attr("astype")("float64", py::arg("copy")=false);
+    }
+    // A base owning nothing stops the view copying the grid: the view keeps
+    // the simulation, and so the grid's buffers, alive (see the wrapper)
+    const py::capsule base(grid.data(), [](void*) {});
+    py::array view(py::dtype::of<real_t>(), shape, strides, grid.data(), base);
+    view.attr("setflags")(false);
+    return view;
+}
+
+bool SimDP::pyprep_t_epochs()
+{
+    pyarray_t_epochs = pyview_buffer(t_epochs, {n_epochs});
     return true;
 }
 
 bool SimDP::pyprep_mean_densities()
 {
-    py_array_t mean_densities_array(n_epochs);
-    auto mean_densities_proxy = mean_densities_array.mutable_unchecked();
-    for (auto i=0; i<n_epochs; i++)
+    pyarray_mean_densities = pyview_buffer(mean_densities, {n_epochs});
+    return true;
+}
+
+bool SimDP::pyprep_observables()
+{
+    pyarray_observables.clear();
+    for (const auto& series : observable_series)
     {
-        mean_densities_proxy(i) = mean_densities[i];
-    };
-    pyarray_mean_densities = mean_densities_array;
+        pyarray_observables.push_back(pyview_buffer(series, {n_epochs}));
+    }
     return true;
 }
 
-bool SimDP::pyprep_density_grid()
+bool SimDP::pyprep_frames()
 {
-    if (not (p.n_cells == p.n_x * p.n_y * p.n_z)) 
+    if (n_epochs_per_frame==0) 
     { 
-        std::cout << "prep_density: grid size problem" << std::endl;
-        return false; 
+        pyarray_frames = py_array_t();
+        return true; 
     }
-    // Assume we're working with a <=2d grid for now
-    py_array_t density_array({p.n_x, p.n_y});
-    auto density_proxy = density_array.mutable_unchecked();
-    for (auto i=0; i<p.n_cells; i++)
-    {
-        int x = i % p.n_x;
-        int y = i / p.n_x;
-        density_proxy(x, y) = dpLangevin->get_density_grid_value(i);
-    };
-    pyarray_density = density_array;
+    pyarray_frames = pyview_buffer(frames, {n_frames, n_frame_y, n_frame_x});
     return true;
-}
\ No newline at end of file
+}
+
+//! Copy, or view, of the density grid as it is now: views are made afresh
+//! on every call, since Euler and implicit steps swap the grid buffers
+py::array SimDP::pyarray_density_grid(const bool is_view) const
+{
+    switch (p.precision)
+    {
+        case (Precision::FLOAT32):
+            return pyarray_grid(
+                static_cast<DPLangevin<float>*>(dpLangevin)->get_density_grid(),
+                p, is_view
+            );
+        default:
+            return pyarray_grid(
+                static_cast<DPLangevin<double>*>(dpLangevin)->get_density_grid(),
+                p, is_view
+            );
+    }
+}
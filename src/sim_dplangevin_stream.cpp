@@ -0,0 +1,209 @@
+/**
+ * @file sim_dplangevin_stream.cpp
+ * @brief Streaming of simulation output to disk from a background thread.
+ */
+
+#include <cstring>
+#include <sstream>
+#include <iomanip>
+#include "sim_dplangevin_stream.hpp"
+
+SimDPStream::SimDPStream() : did_fail(false) {}
+
+SimDPStream::~SimDPStream() { close(); }
+
+//! Create (or truncate) the header and binary files, write a provisional
+//! header, and start the writer thread
+bool SimDPStream::open(
+    const std::string& path_stem,
+    const int n_frame_y, const int n_frame_x,
+    const attributes_t& attributes
+)
+{
+    if (is_open()) { return false; }
+    header_path = path_stem + ".json";
+    const auto name_stem = path_stem.substr(path_stem.find_last_of("/\\")+1);
+    series_name = name_stem + "_series.bin";
+    frames_name = name_stem + "_frames.bin";
+    this->attributes = attributes;
+    this->n_frame_y = n_frame_y;
+    this->n_frame_x = n_frame_x;
+    n_series_records = 0;
+    n_frames = 0;
+    did_fail = false;
+    do_stop = false;
+    series_file = std::fopen((path_stem + "_series.bin").c_str(), "wb");
+    frames_file = std::fopen((path_stem + "_frames.bin").c_str(), "wb");
+    if (not series_file or not frames_file or not write_header(false))
+    {
+        if (series_file) { std::fclose(series_file); }
+        if (frames_file) { std::fclose(frames_file); }
+        series_file = frames_file = nullptr;
+        return false;
+    }
+    series_chunk = take_buffer();
+    writer = std::thread(&SimDPStream::work, this);
+    return true;
+}
+
+bool SimDPStream::is_open() const { return (series_file!=nullptr); }
+
+//! Append a time-series record to the current chunk, handing the chunk
+//! over to the writer once full
+void SimDPStream::write_epoch(
+    const long long i_epoch, const double t, const double mean_density
+)
+{
+    const auto offset = series_chunk.size();
+    series_chunk.resize(offset+series_record_size);
+    auto record = series_chunk.data()+offset;
+    std::memcpy(record, &i_epoch, sizeof(long long));
+    std::memcpy(record+sizeof(long long), &t, sizeof(double));
+    std::memcpy(
+        record+sizeof(long long)+sizeof(double), &mean_density, sizeof(double)
+    );
+    n_series_records++;
+    if (series_chunk.size()>=n_series_chunk_records*series_record_size)
+    {
+        push(series_chunk, series_file);
+        series_chunk = take_buffer();
+    }
+}
+
+//! The frame densities are to be written into the returned buffer
+//! (of n_y*n_x doubles) before calling `end_frame`
+double* SimDPStream::begin_frame(const long long i_epoch, const double t)
+{
+    frame_chunk = take_buffer();
+    frame_chunk.resize(
+        frame_header_size
+        + static_cast<size_t>(n_frame_y)*n_frame_x*sizeof(double)
+    );
+    std::memcpy(frame_chunk.data(), &i_epoch, sizeof(long long));
+    std::memcpy(frame_chunk.data()+sizeof(long long), &t, sizeof(double));
+    // Buffers are allocated with fundamental alignment, so this is aligned
+    return reinterpret_cast<double*>(frame_chunk.data()+frame_header_size);
+}
+
+void SimDPStream::end_frame()
+{
+    n_frames++;
+    push(frame_chunk, frames_file);
+}
+
+//! Hand over the last time-series records, let the writer finish the queue,
+//! close the binary files, and rewrite the header with the final record
+//! counts. Returns false if any write failed.
+bool SimDPStream::close()
+{
+    if (not is_open()) { return false; }
+    if (not series_chunk.empty()) { push(series_chunk, series_file); }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        do_stop = true;
+    }
+    cv_queued.notify_one();
+    writer.join();
+    if (std::fclose(series_file)!=0) { did_fail = true; }
+    if (std::fclose(frames_file)!=0) { did_fail = true; }
+    series_file = frames_file = nullptr;
+    free_buffers.clear();
+    if (not write_header(true)) { did_fail = true; }
+    return not did_fail;
+}
+
+std::vector<char> SimDPStream::take_buffer()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free_buffers.empty()) { return std::vector<char>(); }
+    auto bytes = std::move(free_buffers.back());
+    free_buffers.pop_back();
+    bytes.clear();
+    return bytes;
+}
+
+//! Queue a chunk for writing, waiting only if the writer has fallen
+//! too far behind
+void SimDPStream::push(std::vector<char>& bytes, std::FILE* file)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv_written.wait(lock, [&]() {
+            return queue.empty() or n_queued_bytes<max_queued_bytes;
+        });
+        n_queued_bytes += bytes.size();
+        Chunk chunk;
+        chunk.bytes = std::move(bytes);
+        chunk.file = file;
+        queue.push_back(std::move(chunk));
+    }
+    bytes = std::vector<char>();
+    cv_queued.notify_one();
+}
+
+//! Write queued chunks in turn, without holding the lock while writing
+void SimDPStream::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        cv_queued.wait(lock, [&]() { return do_stop or not queue.empty(); });
+        if (queue.empty()) { return; }
+        auto chunk = std::move(queue.front());
+        queue.pop_front();
+        lock.unlock();
+        const auto n_bytes = chunk.bytes.size();
+        if (std::fwrite(chunk.bytes.data(), 1, n_bytes, chunk.file)!=n_bytes)
+        {
+            did_fail = true;
+        }
+        lock.lock();
+        n_queued_bytes -= n_bytes;
+        free_buffers.push_back(std::move(chunk.bytes));
+        cv_written.notify_one();
+    }
+}
+
+//! The header records the layout of the binary files as NumPy dtypes,
+//! and how many records of each have been handed over
+bool SimDPStream::write_header(const bool is_complete) const
+{
+    const unsigned short one = 1;
+    const auto byte_order = (
+        *reinterpret_cast<const unsigned char*>(&one)==1 ? "<" : ">"
+    );
+    std::ostringstream json;
+    json << std::setprecision(17);
+    json << "{\n";
+    json << "  \"format\": \"dplvn-stream\",\n";
+    json << "  \"version\": 1,\n";
+    json << "  \"is_complete\": " << (is_complete ? "true" : "false") << ",\n";
+    json << "  \"byte_order\": \"" << byte_order << "\",\n";
+    json << "  \"series_file\": \"" << series_name << "\",\n";
+    json << "  \"series_dtype\": [[\"i_epoch\", \"" << byte_order << "i8\"], "
+        << "[\"t\", \"" << byte_order << "f8\"], "
+        << "[\"mean_density\", \"" << byte_order << "f8\"]],\n";
+    json << "  \"n_series_records\": " << n_series_records << ",\n";
+    json << "  \"frames_file\": \"" << frames_name << "\",\n";
+    json << "  \"frames_dtype\": [[\"i_epoch\", \"" << byte_order << "i8\"], "
+        << "[\"t\", \"" << byte_order << "f8\"], "
+        << "[\"density\", \"" << byte_order << "f8\", ["
+        << n_frame_y << ", " << n_frame_x << "]]],\n";
+    json << "  \"n_frames\": " << n_frames << ",\n";
+    json << "  \"attributes\": {";
+    for (size_t i=0; i<attributes.size(); i++)
+    {
+        json << (i==0 ? "\n" : ",\n")
+            << "    \"" << attributes[i].first << "\": " << attributes[i].second;
+    }
+    json << "\n  }\n";
+    json << "}\n";
+
+    auto file = std::fopen(header_path.c_str(), "w");
+    if (not file) { return false; }
+    const auto text = json.str();
+    const auto did_write = (
+        std::fwrite(text.data(), 1, text.size(), file)==text.size()
+    );
+    return (std::fclose(file)==0 and did_write);
+}
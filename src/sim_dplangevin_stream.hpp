@@ -0,0 +1,142 @@
+/**
+ * @file sim_dplangevin_stream.hpp
+ * @brief Streaming of simulation output to disk from a background thread.
+ */
+
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+//! Type for named numerical attributes written into a stream header
+typedef std::vector< std::pair<std::string, double> > attributes_t;
+
+/**
+ * @brief Streaming of simulation output to disk from a background thread.
+ *
+ * Output goes to three files sharing a path "stem":
+ *   - `<stem>.json`: a header describing the binary files, with
+ *     simulation attributes, and the numbers of records written; it is
+ *     rewritten, with `"is_complete": true`, when the stream is closed;
+ *   - `<stem>_series.bin`: one record per epoch of
+ *     (int64 i_epoch, float64 t, float64 mean_density);
+ *   - `<stem>_frames.bin`: one record per recorded frame of
+ *     (int64 i_epoch, float64 t, float64 density[n_y][n_x]).
+ *
+ * Binary values are in the machine's byte order, given in the header
+ * (with the NumPy dtypes of the records), so each file can be read
+ * with one call to `numpy.fromfile`. Records are appended as a run goes,
+ * so a file can be read while still being written, trailing partial
+ * record aside.
+ *
+ * The simulation hands over filled buffers of records, which a writer
+ * thread takes in turn and writes to disk: so integration doesn't wait
+ * for disk I/O, unless the writer falls more than `max_queued_bytes`
+ * behind. Buffers are recycled once written.
+ */
+class SimDPStream
+{
+private:
+    //! A buffer of records, and the file they're bound for
+    struct Chunk
+    {
+        std::vector<char> bytes;
+        std::FILE* file;
+    };
+
+    //! Bytes of queued records beyond which the simulation waits for the writer
+    static const size_t max_queued_bytes = 256*1024*1024;
+    //! Number of time-series records gathered into each chunk
+    static const int n_series_chunk_records = 4096;
+    //! Byte size of each time-series record
+    static const size_t series_record_size =
+        sizeof(long long)+2*sizeof(double);
+    //! Byte size of the epoch and time at the start of each frame record
+    static const size_t frame_header_size = sizeof(long long)+sizeof(double);
+
+    //! Path of the JSON header file
+    std::string header_path;
+    //! File names (without directory) of the binary files
+    std::string series_name, frames_name;
+    //! Header entries describing the simulation
+    attributes_t attributes;
+    //! Time-series output file
+    std::FILE* series_file = nullptr;
+    //! Frames output file
+    std::FILE* frames_file = nullptr;
+    //! Frame shape: number of rows (y) and columns (x)
+    int n_frame_y = 0, n_frame_x = 0;
+    //! Number of time-series records handed over so far
+    long long n_series_records = 0;
+    //! Number of frames handed over so far
+    long long n_frames = 0;
+    //! Time-series records not yet handed over
+    std::vector<char> series_chunk;
+    //! Frame record being filled (between `begin_frame` and `end_frame`)
+    std::vector<char> frame_chunk;
+
+    //! Writer thread
+    std::thread writer;
+    //! Guards the queue and buffer pool below
+    std::mutex mutex;
+    //! Signals the writer that a chunk is queued (or to stop)
+    std::condition_variable cv_queued;
+    //! Signals the simulation that the writer has caught up a little
+    std::condition_variable cv_written;
+    //! Chunks waiting to be written
+    std::deque<Chunk> queue;
+    //! Total bytes in the queued chunks
+    size_t n_queued_bytes = 0;
+    //! Written buffers, available for reuse
+    std::vector< std::vector<char> > free_buffers;
+    //! Flag telling the writer to finish the queue and exit
+    bool do_stop = false;
+    //! Flag recording any failed write
+    std::atomic<bool> did_fail;
+
+    //! Writer thread main loop
+    void work();
+    //! Fetch an empty buffer, recycled if possible
+    std::vector<char> take_buffer();
+    //! Queue a filled buffer for writing to `file`
+    void push(std::vector<char>& bytes, std::FILE* file);
+    //! Write (or rewrite) the JSON header file
+    bool write_header(const bool is_complete) const;
+
+public:
+    //! Constructor: no files are opened until `open`
+    SimDPStream();
+    //! Destructor: closes the stream if open
+    ~SimDPStream();
+    SimDPStream(const SimDPStream&) = delete;
+    SimDPStream& operator=(const SimDPStream&) = delete;
+
+    //! Create the output files and start the writer thread
+    bool open(
+        const std::string& path_stem,
+        const int n_frame_y, const int n_frame_x,
+        const attributes_t& attributes
+    );
+    //! Whether the stream is open
+    bool is_open() const;
+    //! Append a time-series record
+    void write_epoch(
+        const long long i_epoch, const double t, const double mean_density
+    );
+    //! Start a frame record, returning the buffer for its n_y*n_x densities
+    double* begin_frame(const long long i_epoch, const double t);
+    //! Hand over the frame record started by `begin_frame`
+    void end_frame();
+    //! Write out everything outstanding, stop the writer, and finish the header
+    bool close();
+};
+
+#endif
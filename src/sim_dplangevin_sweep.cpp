@@ -0,0 +1,272 @@
+/**
+ * @file sim_dplangevin_sweep.cpp
+ * @brief Methods of class that manages a sweep of DP Langevin simulations
+ * over coefficient variants and random seeds.
+ */
+
+#include <algorithm>
+#include <limits>
+#include "sim_dplangevin_sweep.hpp"
+
+/**
+ * @details Constructor for class that manages a sweep of DP Langevin
+ * simulations: run #i is of coefficient variant #(i / n_seeds), with
+ * seed #(i % n_seeds), so the runs of each variant are listed together.
+ * Each variant must be a list of four coefficients, (linear, quadratic,
+ * diffusion, noise), which `initialize` checks.
+ */
+SimDPSweep::SimDPSweep(
+    const std::vector<dbl_vec_t> coefficients,
+    const int_vec_t random_seeds,
+    const double t_final,
+    const double dx, const double dt,
+    const GridDimension grid_dimension,
+    const int_vec_t grid_size,
+    const gt_vec_t grid_topologies,
+    const bc_vec_t boundary_conditions,
+    const dbl_vec_t bc_values,
+    const InitialCondition initial_condition,
+    const dbl_vec_t ic_values,
+    const IntegrationMethod integration_method,
+    const bool do_verbose,
+    const RandomGenerator random_generator,
+    const Precision precision,
+    const int n_threads
+) : variants(coefficients),
+    random_seeds(random_seeds),
+    n_runs(static_cast<int>(coefficients.size()*random_seeds.size())),
+    p(
+        t_final,
+        dx,
+        dt,
+        random_seeds.empty() ? 0 : random_seeds[0],
+        grid_dimension,
+        grid_size,
+        grid_topologies,
+        boundary_conditions,
+        bc_values,
+        initial_condition,
+        ic_values,
+        integration_method,
+        random_generator,
+        precision
+    )
+{
+    thread_pool = new ThreadPool(n_threads);
+    if (do_verbose)
+    {
+        p.print();
+        std::cout << "n_variants: " << variants.size() << std::endl;
+        std::cout << "n_seeds: " << this->random_seeds.size() << std::endl;
+        std::cout << "n_threads: " << thread_pool->get_n_threads() << std::endl;
+    }
+}
+
+//! Destructor: release the thread pool
+SimDPSweep::~SimDPSweep()
+{
+    delete thread_pool;
+}
+
+//! Create (but don't initialize) the simulation of run `i_run`, integrated
+//! in the thread it's handed to
+SimDP* SimDPSweep::create_run(const int i_run) const
+{
+    const auto n_seeds = static_cast<int>(random_seeds.size());
+    const auto& variant = variants[i_run/n_seeds];
+    auto simulation = new SimDP(
+        variant[0], variant[1], variant[2], variant[3],
+        p.t_final, p.dx, p.dt,
+        random_seeds[i_run%n_seeds],
+        p.grid_dimension, p.grid_size, p.grid_topologies,
+        p.boundary_conditions, p.bc_values,
+        p.initial_condition, p.ic_values,
+        p.integration_method, false,
+        p.random_generator, p.precision, 1
+    );
+    return simulation;
+}
+
+//! Set up, integrate and release the simulation of run `i_run`, epoch by
+//! epoch until t_final, or until its grid falls into the absorbing state:
+//! its mean density is then zero at every later epoch, as already recorded
+bool SimDPSweep::integrate_run(const int i_run)
+{
+    auto simulation = create_run(i_run);
+    auto did_integrate = simulation->initialize(n_decimals);
+    auto i_epoch = 0;
+    while (
+        did_integrate and i_epoch<n_epochs-1
+        and not simulation->dpLangevin->is_absorbed()
+    )
+    {
+        did_integrate = simulation->run(1);
+        i_epoch++;
+    }
+    if (did_integrate)
+    {
+        std::copy(
+            simulation->mean_densities->begin(),
+            simulation->mean_densities->begin() + i_epoch+1,
+            mean_densities.begin() + static_cast<size_t>(i_run)*n_epochs
+        );
+        n_epochs_run[i_run] = i_epoch+1;
+        if (simulation->dpLangevin->is_absorbed())
+        {
+            t_absorbed[i_run] = t_epochs[i_epoch];
+        }
+    }
+    delete simulation;
+    return did_integrate;
+}
+
+//! Method to be called first to set up the sweep: the variants are checked,
+//! and a first simulation is set up to find the epoch times (see 
+//! `SimDP::initialize`) and to wire the grid: the sweep holds on to the 
+//! wiring, so every run finds it in the cache of grid wirings in use
+bool SimDPSweep::initialize(int n_decimals)
+{
+    is_initialized = false;
+    did_run = false;
+    if (n_runs==0)
+    {
+        std::cout << "SimDPSweep::initialize failure: no variants or no seeds" << std::endl;
+        return false;
+    }
+    for (const auto& variant : variants)
+    {
+        if (variant.size()!=4)
+        {
+            std::cout << "SimDPSweep::initialize failure: each variant must be (linear, quadratic, diffusion, noise)" << std::endl;
+            return false;
+        }
+    }
+    this->n_decimals = n_decimals;
+    grid_wiring.reset();
+    auto simulation = create_run(0);
+    if (simulation->initialize(n_decimals))
+    {
+        grid_wiring = simulation->dpLangevin->get_grid_wiring();
+        n_epochs = simulation->get_n_epochs();
+        t_epochs.assign(n_epochs, 0.0);
+        auto t = simulation->get_t_next_epoch();
+        for (auto i=1; i<n_epochs; i++)
+        {
+            t_epochs[i] = t;
+            t = simulation->next_epoch_time(t);
+        }
+        is_initialized = true;
+    }
+    delete simulation;
+    return is_initialized;
+}
+
+//! Method to carry out every run of the sweep, each from its initial
+//! condition to t_final (or absorption), handing runs out one at a time to
+//! the threads of the pool; it can be rerun, repeating the whole sweep.
+//! No Python objects are touched here, so the wrapper lets other Python
+//! threads carry on while the sweep runs.
+bool SimDPSweep::run()
+{
+    if (not is_initialized)
+    {
+        std::cout << "SimDPSweep::run failure: must initialize first" << std::endl;
+        return false;
+    }
+    mean_densities.assign(static_cast<size_t>(n_runs)*n_epochs, 0.0);
+    n_epochs_run.assign(n_runs, 0);
+    t_absorbed.assign(n_runs, std::numeric_limits<double>::quiet_NaN());
+    std::vector<unsigned char> did_succeed(n_runs, 0);
+    thread_pool->parallel_for(
+        n_runs,
+        [&](const int i_run) { did_succeed[i_run] = integrate_run(i_run); }
+    );
+    did_run = std::all_of(
+        did_succeed.begin(), did_succeed.end(),
+        [](const unsigned char is_ok) { return is_ok; }
+    );
+    return did_run;
+}
+
+/**
+ * @details Method to be called after `run`: the epoch times, the mean
+ * density time series of every run as one (n_runs, n_epochs) array,
+ * and a table of results with one entry per run, are made available
+ * to Python. The table is a dict of equal-length columns (so
+ * `pandas.DataFrame(sweep.get_results())` makes a data frame of it):
+ *   - "i_variant", "linear", "quadratic", "diffusion", "noise":
+ *     the coefficient variant of the run;
+ *   - "random_seed": its seed;
+ *   - "n_epochs": the number of epochs integrated, epoch#0 included;
+ *   - "t_absorbed": the time it fell into the absorbing state,
+ *     or NaN if it survived to t_final;
+ *   - "final_mean_density": its mean density at t_final.
+ */
+bool SimDPSweep::postprocess()
+{
+    if (not did_run)
+    {
+        std::cout << "SimDPSweep::postprocess failure: no data to process yet" << std::endl;
+        return false;
+    }
+    pyarray_t_epochs = py_array_t(n_epochs, t_epochs.data());
+    pyarray_mean_densities = py_array_t(
+        std::vector<py::ssize_t>({n_runs, n_epochs}), mean_densities.data()
+    );
+    const auto n_seeds = static_cast<int>(random_seeds.size());
+    // Columns of the table, filled run by run from `entry(i_run)`
+    auto real_column = [&](const std::function<double(int)>& entry)
+    {
+        py_array_t column(n_runs);
+        auto column_proxy = column.mutable_unchecked();
+        for (auto i_run=0; i_run<n_runs; i_run++) 
+        { 
+            column_proxy(i_run) = entry(i_run); 
+        }
+        return column;
+    };
+    auto int_column = [&](const std::function<int(int)>& entry)
+    {
+        py::array_t<int> column(n_runs);
+        auto column_proxy = column.mutable_unchecked();
+        for (auto i_run=0; i_run<n_runs; i_run++) 
+        { 
+            column_proxy(i_run) = entry(i_run); 
+        }
+        return column;
+    };
+    auto coefficient_column = [&](const int i_coefficient)
+    {
+        return real_column([&](const int i_run) 
+            { return variants[i_run/n_seeds][i_coefficient]; });
+    };
+    pydict_results = py::dict();
+    pydict_results["i_variant"] = int_column(
+        [&](const int i_run) { return i_run/n_seeds; }
+    );
+    pydict_results["linear"] = coefficient_column(0);
+    pydict_results["quadratic"] = coefficient_column(1);
+    pydict_results["diffusion"] = coefficient_column(2);
+    pydict_results["noise"] = coefficient_column(3);
+    pydict_results["random_seed"] = int_column(
+        [&](const int i_run) { return random_seeds[i_run%n_seeds]; }
+    );
+    pydict_results["n_epochs"] = int_column(
+        [&](const int i_run) { return n_epochs_run[i_run]; }
+    );
+    pydict_results["t_absorbed"] = real_column(
+        [&](const int i_run) { return t_absorbed[i_run]; }
+    );
+    pydict_results["final_mean_density"] = real_column(
+        [&](const int i_run) 
+            { return mean_densities[static_cast<size_t>(i_run+1)*n_epochs - 1]; }
+    );
+    return true;
+}
+
+int SimDPSweep::get_n_runs() const { return n_runs; }
+int SimDPSweep::get_n_epochs() const { return n_epochs; }
+py_array_t SimDPSweep::get_t_epochs() const { return pyarray_t_epochs; }
+py_array_t SimDPSweep::get_mean_densities() const
+    { return pyarray_mean_densities; }
+py::dict SimDPSweep::get_results() const { return pydict_results; }
@@ -0,0 +1,120 @@
+/**
+ * @file sim_dplangevin_sweep.hpp
+ * @brief Class that manages a sweep of DP Langevin simulations over
+ * coefficient variants and random seeds.
+ */
+
+#ifndef SIMDPSWEEP_HPP
+#define SIMDPSWEEP_HPP
+
+#include "sim_dplangevin.hpp"
+
+/**
+ * @brief Class that manages a sweep of DP Langevin simulations over
+ * coefficient variants and random seeds.
+ *
+ * Runs a simulation for every combination of a list of coefficient
+ * variants, each given as (linear, quadratic, diffusion, noise), and a list
+ * of random seeds, on grids otherwise identical: e.g., to scan the linear
+ * coefficient across the critical point with several seeds at each value.
+ * The grid is wired once, and every run shares that wiring.
+ *
+ * Each run is integrated in a single thread, and the runs are handed out
+ * one at a time to a pool of `n_threads` threads. A run that falls into
+ * the absorbing state is stopped there, since its density would stay zero
+ * to t_final: so runs below the critical point cost little, and each
+ * run's results are the same as those of a lone SimDP simulation with the
+ * same coefficients and seed.
+ *
+ * Only runs in progress hold a density grid, so the memory needed
+ * grows with the number of threads, not with the number of runs.
+ */
+class SimDPSweep
+{
+private:
+    //! Coefficient variants, each as (linear, quadratic, diffusion, noise)
+    std::vector<dbl_vec_t> variants;
+    //! Random seeds, each run with every variant
+    int_vec_t random_seeds;
+    //! Number of runs: one per variant per seed
+    int n_runs;
+    //! Model simulation parameters shared by every run (but for the seed)
+    Parameters p;
+    //! Pool of threads sharing the runs (pointer to pool)
+    ThreadPool *thread_pool;
+    //! Cell wiring of the grid, held so that it stays cached for every run to share
+    std::shared_ptr<const grid_wiring_t> grid_wiring;
+    //! Rounding number of decimal places of epoch times
+    int n_decimals = 0;
+    //! Total number of simulation epochs of each run, epoch#0 included
+    int n_epochs = 0;
+    //! Vector time-series of epochs, the same for every run
+    dbl_vec_t t_epochs;
+    //! Mean density time-series of every run, run by run (zero after absorption)
+    dbl_vec_t mean_densities;
+    //! Number of epochs each run integrated before stopping, epoch#0 included
+    int_vec_t n_epochs_run;
+    //! Time at which each run fell into the absorbing state (NaN if it never did)
+    dbl_vec_t t_absorbed;
+    //! Python-compatible array of epochs time-series
+    py_array_t pyarray_t_epochs;
+    //! Python-compatible array of mean density time-series, one row per run
+    py_array_t pyarray_mean_densities;
+    //! Table of results, one entry per run, as a dict of Python-compatible columns
+    py::dict pydict_results;
+    //! Flag whether the sweep has been initialized or not
+    bool is_initialized = false;
+    //! Flag whether all the runs have been integrated or not
+    bool did_run = false;
+
+    //! Create the simulation of run `i_run`
+    SimDP* create_run(const int i_run) const;
+    //! Integrate run `i_run` to t_final, or until it's absorbed, and record its results
+    bool integrate_run(const int i_run);
+
+public:
+    //! Constructor
+    SimDPSweep(
+        const std::vector<dbl_vec_t> coefficients,
+        const int_vec_t random_seeds,
+        const double t_final,
+        const double dx, const double dt,
+        const GridDimension grid_dimension,
+        const int_vec_t grid_size,
+        const gt_vec_t grid_topologies,
+        const bc_vec_t boundary_conditions,
+        const dbl_vec_t bc_values,
+        const InitialCondition initial_condition,
+        const dbl_vec_t ic_values,
+        const IntegrationMethod integration_method,
+        const bool do_verbose,
+        const RandomGenerator random_generator,
+        const Precision precision,
+        const int n_threads
+    );
+    //! Destructor
+    ~SimDPSweep();
+    SimDPSweep(const SimDPSweep&) = delete;
+    SimDPSweep& operator=(const SimDPSweep&) = delete;
+    //! Check the sweep, and wire the grid shared by all the runs
+    bool initialize(int n_decimals);
+    //! Execute every run of the sweep, to t_final or absorption
+    bool run();
+    //! Process the sweep results data if available
+    bool postprocess();
+
+    // Utilities provided to Python via the wrapper
+
+    //! Fetch the number of runs: variants times seeds
+    int get_n_runs() const;
+    //! Fetch the total number of simulation epochs of each run
+    int get_n_epochs() const;
+    //! Fetch a times-series vector of the simulation epochs as a Python array
+    py_array_t get_t_epochs() const;
+    //! Fetch the grid-averaged density time series of all runs as a 2D Python array
+    py_array_t get_mean_densities() const;
+    //! Fetch the table of results, one entry per run, as a dict of Python arrays
+    py::dict get_results() const;
+};
+
+#endif
@@ -12,5 +12,53 @@ double SimDP::get_t_current_epoch() const { return t_current_epoch; }
 double SimDP::get_t_next_epoch() const { return t_next_epoch; }
 py_array_t SimDP::get_t_epochs() const { return pyarray_t_epochs; }
 py_array_t SimDP::get_mean_densities() const { return pyarray_mean_densities; }
-py_array_t SimDP::get_density() const { return pyarray_density; }
+py_array_t SimDP::get_observable(const Observable observable) const
+{
+    for (size_t i=0; i<observables.size() and i<pyarray_observables.size(); i++)
+    {
+        if (observables[i]==observable) { return pyarray_observables[i]; }
+    }
+    std::cout << "SimDP::get_observable failure: not measured or not postprocessed" << std::endl;
+    return py_array_t();
+}
+//! A float64 copy of the grid as it is now, which stays valid as a snapshot
+py::array SimDP::get_density() const 
+{
+    if (not is_initialized) 
+    { 
+        std::cout << "SimDP::get_density failure: must initialize first" << std::endl;
+        return py::array(); 
+    }
+    if (is_busy("get_density")) { return py::array(); }
+    return pyarray_density_grid(false);
+}
+//! A read-only view of the buffer holding the grid now, which shows the 
+//! grid only until the next `run` (after which it may show scratch values)
+py::array SimDP::get_density_view() const
+{
+    if (not is_initialized) 
+    { 
+        std::cout << "SimDP::get_density_view failure: must initialize first" << std::endl;
+        return py::array(); 
+    }
+    if (is_busy("get_density_view")) { return py::array(); }
+    return pyarray_density_grid(true);
+}
+py_array_t SimDP::get_frames() const { return pyarray_frames; }
 
+
+SimDPRun::SimDPRun(
+    std::shared_future<bool> result,
+    std::shared_ptr< std::atomic<int> > n_epochs_done,
+    const int n_epochs
+) : result(result), n_epochs_done(n_epochs_done), n_epochs(n_epochs) {}
+
+bool SimDPRun::done() const
+{
+    return (
+        result.wait_for(std::chrono::seconds(0))==std::future_status::ready
+    );
+}
+bool SimDPRun::wait() const { return result.get(); }
+int SimDPRun::get_n_epochs_done() const { return n_epochs_done->load(); }
+int SimDPRun::get_n_epochs() const { return n_epochs; }
@@ -8,6 +8,8 @@
 // Essential for STL container conversions
 #include <pybind11/stl.h> 
 #include "sim_dplangevin.hpp"
+#include "sim_dplangevin_ensemble.hpp"
+#include "sim_dplangevin_sweep.hpp"
 
 /**
  * @details Pybind11 wrapper between C++ and Python for SimDP application.
@@ -57,8 +59,37 @@ PYBIND11_MODULE(dplvn, module)
     py::enum_<IntegrationMethod>(module, "IntegrationMethod")
         .value("EULER", IntegrationMethod::EULER)
         .value("RUNGE_KUTTA", IntegrationMethod::RUNGE_KUTTA)
+        .value("RUNGE_KUTTA_BLOCKED", IntegrationMethod::RUNGE_KUTTA_BLOCKED)
+        .value("IMPLICIT_DIFFUSION", IntegrationMethod::IMPLICIT_DIFFUSION)
+        .export_values();
+
+    py::enum_<RandomGenerator>(module, "RandomGenerator")
+        .value("MERSENNE_TWISTER", RandomGenerator::MERSENNE_TWISTER)
+        .value("PHILOX", RandomGenerator::PHILOX)
+        .export_values();
+
+    py::enum_<Precision>(module, "Precision")
+        .value("FLOAT64", Precision::FLOAT64)
+        .value("FLOAT32", Precision::FLOAT32)
+        .export_values();
+
+    py::enum_<Observable>(module, "Observable")
+        .value("ACTIVE_FRACTION", Observable::ACTIVE_FRACTION)
+        .value("MEAN_SQUARED_DENSITY", Observable::MEAN_SQUARED_DENSITY)
+        .value("DENSITY_VARIANCE", Observable::DENSITY_VARIANCE)
+        .value("SPREAD_RADIUS_SQUARED", Observable::SPREAD_RADIUS_SQUARED)
+        .value("SURVIVAL", Observable::SURVIVAL)
         .export_values();
         
+    py::class_<SimDPRun>(module, "SimDPRun")
+        .def("done", &SimDPRun::done)
+        .def(
+            "wait", &SimDPRun::wait, 
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def("get_n_epochs_done", &SimDPRun::get_n_epochs_done)
+        .def("get_n_epochs", &SimDPRun::get_n_epochs);
+
     py::class_<SimDP>(module, "SimDP")
         .def(
             py::init<
@@ -74,7 +105,10 @@ PYBIND11_MODULE(dplvn, module)
                 InitialCondition,
                 dbl_vec_t,
                 IntegrationMethod,
-                bool
+                bool,
+                RandomGenerator,
+                Precision,
+                int
             >(),
             "Simulation of DP Langevin equation",
             py::arg("linear") = 1.0, 
@@ -93,10 +127,48 @@ PYBIND11_MODULE(dplvn, module)
             py::arg("initial_condition") = InitialCondition::RANDOM_UNIFORM,
             py::arg("ic_values") = dbl_vec_t(3),
             py::arg("integration_method") = IntegrationMethod::RUNGE_KUTTA,
-            py::arg("do_verbose") = false
+            py::arg("do_verbose") = false,
+            py::arg("random_generator") = RandomGenerator::MERSENNE_TWISTER,
+            py::arg("precision") = Precision::FLOAT64,
+            py::arg("n_threads") = 1
+        )
+        .def(
+            "initialize", &SimDP::initialize,
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def(
+            "run", &SimDP::run, 
+            py::call_guard<py::gil_scoped_release>()
+        )
+        // The handle keeps the simulation alive while it exists
+        .def("run_async", &SimDP::run_async, py::keep_alive<0, 1>())
+        .def("set_observables", &SimDP::set_observables)
+        .def(
+            "set_adaptive_dt", &SimDP::set_adaptive_dt,
+            py::arg("error_tolerance"), py::arg("dt_min") = 0.0
+        )
+        .def(
+            "set_frame_recorder", &SimDP::set_frame_recorder,
+            py::arg("n_epochs_per_frame"), py::arg("stride") = 1
+        )
+        .def(
+            "open_stream", &SimDP::open_stream,
+            py::arg("path_stem"), 
+            py::arg("n_epochs_per_frame") = 0, 
+            py::arg("stride") = 1
+        )
+        .def(
+            "close_stream", &SimDP::close_stream,
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def(
+            "save_checkpoint", &SimDP::save_checkpoint,
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def(
+            "load_checkpoint", &SimDP::load_checkpoint,
+            py::call_guard<py::gil_scoped_release>()
         )
-        .def("initialize", &SimDP::initialize)
-        .def("run", &SimDP::run)
         .def("postprocess", &SimDP::postprocess)
         .def("get_n_epochs", &SimDP::get_n_epochs)
         .def("get_i_next_epoch", &SimDP::get_i_next_epoch)
@@ -105,5 +177,128 @@ PYBIND11_MODULE(dplvn, module)
         .def("get_t_current_epoch", &SimDP::get_t_current_epoch)
         .def("get_t_epochs", &SimDP::get_t_epochs)
         .def("get_mean_densities", &SimDP::get_mean_densities)
-        .def("get_density", &SimDP::get_density);
+        .def("get_observable", &SimDP::get_observable)
+        .def("get_density", &SimDP::get_density)
+        // The view keeps the simulation, whose buffers it reads, alive
+        .def("get_density_view", &SimDP::get_density_view, py::keep_alive<0, 1>())
+        .def("get_frames", &SimDP::get_frames);
+
+    // The GIL is released while replicas are initialized and run, 
+    // since no Python objects are touched until `postprocess`
+    py::class_<SimDPEnsemble>(module, "SimDPEnsemble")
+        .def(
+            py::init<
+                int,
+                double, double, 
+                double, double, 
+                double, double, double,
+                int, 
+                GridDimension,
+                int_vec_t,
+                gt_vec_t,
+                bc_vec_t,
+                dbl_vec_t,
+                InitialCondition,
+                dbl_vec_t,
+                IntegrationMethod,
+                bool,
+                RandomGenerator,
+                Precision,
+                int
+            >(),
+            "Ensemble of independent simulations of DP Langevin equation",
+            py::arg("n_replicas") = 1,
+            py::arg("linear") = 1.0, 
+            py::arg("quadratic") = 2.0, 
+            py::arg("diffusion") = 0.1,
+            py::arg("noise") = 1.0,
+            py::arg("t_final") = 100.0,
+            py::arg("dx") = 0.5,
+            py::arg("dt") = 0.01,
+            py::arg("random_seed") = 1,
+            py::arg("grid_dimension") = GridDimension::D2,
+            py::arg("grid_size") = int_vec_t(2),
+            py::arg("grid_topologies") = gt_vec_t(2),
+            py::arg("boundary_conditions") = bc_vec_t(4),
+            py::arg("bc_values") = dbl_vec_t(4),
+            py::arg("initial_condition") = InitialCondition::RANDOM_UNIFORM,
+            py::arg("ic_values") = dbl_vec_t(3),
+            py::arg("integration_method") = IntegrationMethod::RUNGE_KUTTA,
+            py::arg("do_verbose") = false,
+            py::arg("random_generator") = RandomGenerator::MERSENNE_TWISTER,
+            py::arg("precision") = Precision::FLOAT64,
+            py::arg("n_threads") = 0
+        )
+        .def(
+            "initialize", &SimDPEnsemble::initialize,
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def(
+            "run", &SimDPEnsemble::run, 
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def("set_observables", &SimDPEnsemble::set_observables)
+        .def("postprocess", &SimDPEnsemble::postprocess)
+        .def("get_n_replicas", &SimDPEnsemble::get_n_replicas)
+        .def("get_n_epochs", &SimDPEnsemble::get_n_epochs)
+        .def("get_i_current_epoch", &SimDPEnsemble::get_i_current_epoch)
+        .def("get_t_current_epoch", &SimDPEnsemble::get_t_current_epoch)
+        .def("get_t_epochs", &SimDPEnsemble::get_t_epochs)
+        .def("get_mean_densities", &SimDPEnsemble::get_mean_densities)
+        .def("get_observable", &SimDPEnsemble::get_observable);
+
+    // The GIL is released while the runs are set up and integrated, 
+    // since no Python objects are touched until `postprocess`
+    py::class_<SimDPSweep>(module, "SimDPSweep")
+        .def(
+            py::init<
+                std::vector<dbl_vec_t>,
+                int_vec_t,
+                double, double, double,
+                GridDimension,
+                int_vec_t,
+                gt_vec_t,
+                bc_vec_t,
+                dbl_vec_t,
+                InitialCondition,
+                dbl_vec_t,
+                IntegrationMethod,
+                bool,
+                RandomGenerator,
+                Precision,
+                int
+            >(),
+            "Sweep of simulations of DP Langevin equation over coefficients and seeds",
+            py::arg("coefficients"),
+            py::arg("random_seeds") = int_vec_t({1}),
+            py::arg("t_final") = 100.0,
+            py::arg("dx") = 0.5,
+            py::arg("dt") = 0.01,
+            py::arg("grid_dimension") = GridDimension::D2,
+            py::arg("grid_size") = int_vec_t(2),
+            py::arg("grid_topologies") = gt_vec_t(2),
+            py::arg("boundary_conditions") = bc_vec_t(4),
+            py::arg("bc_values") = dbl_vec_t(4),
+            py::arg("initial_condition") = InitialCondition::RANDOM_UNIFORM,
+            py::arg("ic_values") = dbl_vec_t(3),
+            py::arg("integration_method") = IntegrationMethod::RUNGE_KUTTA,
+            py::arg("do_verbose") = false,
+            py::arg("random_generator") = RandomGenerator::MERSENNE_TWISTER,
+            py::arg("precision") = Precision::FLOAT64,
+            py::arg("n_threads") = 0
+        )
+        .def(
+            "initialize", &SimDPSweep::initialize,
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def(
+            "run", &SimDPSweep::run, 
+            py::call_guard<py::gil_scoped_release>()
+        )
+        .def("postprocess", &SimDPSweep::postprocess)
+        .def("get_n_runs", &SimDPSweep::get_n_runs)
+        .def("get_n_epochs", &SimDPSweep::get_n_epochs)
+        .def("get_t_epochs", &SimDPSweep::get_t_epochs)
+        .def("get_mean_densities", &SimDPSweep::get_mean_densities)
+        .def("get_results", &SimDPSweep::get_results);
 }
\ No newline at end of file
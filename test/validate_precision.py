@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+
+"""!
+@file validate_precision.py
+@brief Compare survival curves of single- and double-precision simulations.
+
+Runs an ensemble (`SimDPEnsemble`) of single-seed simulations with float64
+density grids and another with float32 grids, each across all cores, and
+compares the survival probability P(t), i.e., the fraction of runs not yet
+absorbed, at a series of times.
+The two ensembles use different random seeds, so the curves can only
+agree statistically: each difference is checked against three standard
+errors of the difference between two binomial proportions.
+"""
+
+# import sys, os
+# sys.path.insert(0, os.path.join(os.path.pardir, "build"))
+import numpy as np
+from numpy.typing import NDArray
+import dplvn # type: ignore
+
+n_replicas: int = 200
+n_samples: int = 10
+
+def survival_curve(precision, seed_offset: int) -> tuple[NDArray, NDArray]:
+    ensemble = dplvn.SimDPEnsemble(
+        n_replicas=n_replicas,
+        linear=0.8, quadratic=2.0, diffusion=0.1, noise=1.0,
+        t_final=50.0-1e-10,
+        dx=0.5, dt=0.01,
+        random_seed=seed_offset,
+        grid_dimension=dplvn.D2,
+        grid_size=(64,64,),
+        grid_topologies=(dplvn.PERIODIC, dplvn.PERIODIC,),
+        boundary_conditions=(
+            dplvn.FLOATING, dplvn.FLOATING, dplvn.FLOATING, dplvn.FLOATING
+        ),
+        bc_values=(0, 0, 0, 0,),
+        initial_condition=dplvn.SINGLE_SEED,
+        ic_values=(1, 32, 32,),
+        integration_method=dplvn.RUNGE_KUTTA,
+        random_generator=dplvn.PHILOX,
+        precision=precision,
+    )
+    if not ensemble.initialize(5):
+        raise Exception("Failed to initialize ensemble")
+    n_epochs: int = ensemble.get_n_epochs()
+    if not ensemble.run(n_epochs-1) or not ensemble.postprocess():
+        raise Exception("Failed to run ensemble")
+    i_samples = (np.arange(n_samples+1)*(n_epochs-1))//n_samples
+    mean_densities: NDArray = ensemble.get_mean_densities()[:, i_samples]
+    t_samples: NDArray = ensemble.get_t_epochs()[i_samples]
+    return (t_samples, np.mean(mean_densities>0, axis=0))
+
+def main() -> None:
+    bold = lambda str: ("\033[1m" + str + "\033[0m")
+
+    print()
+    print(bold(f"dplvn version:  {dplvn.__version__}"))
+    print()
+    print(bold(f"Survival curves from {n_replicas} replicas at each precision"))
+    print()
+
+    t_samples, p_float64 = survival_curve(dplvn.FLOAT64, 1000)
+    _, p_float32 = survival_curve(dplvn.FLOAT32, 100000)
+    p_pooled: NDArray = (p_float64+p_float32)/2
+    tolerance: NDArray = (
+        3*np.sqrt(2*p_pooled*(1-p_pooled)/n_replicas) + 1/n_replicas
+    )
+    is_consistent: NDArray = (np.abs(p_float64-p_float32)<=tolerance)
+    print("       t    float64    float32  tolerance")
+    for t, p64, p32, dp, ok in zip(
+        t_samples, p_float64, p_float32, tolerance, is_consistent
+    ):
+        print(f"{t:8.2f}   {p64:8.3f}   {p32:8.3f}   {dp:8.3f}  "
+              + ("" if ok else bold("inconsistent")))
+    print()
+    if not np.all(is_consistent):
+        raise Exception("Single- and double-precision survival curves differ")
+    print(bold("Single- and double-precision survival curves agree"))
+
+if __name__ == "__main__":
+    main()